@@ -0,0 +1,356 @@
+/*
+  ==============================================================================
+
+    AudioThreadGuard.cpp
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "AudioThreadGuard.h"
+
+#if ONEXOSC_AUDIO_THREAD_GUARD && JUCE_LINUX && defined (__GLIBC__)
+ #define ONEXOSC_GUARD_INTERPOSE_LIBC 1
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <time.h>
+ #include <unistd.h>
+#else
+ #define ONEXOSC_GUARD_INTERPOSE_LIBC 0
+#endif
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <dlfcn.h>
+#endif
+
+#if JUCE_MSVC
+ #include <intrin.h>
+ #define ONEXOSC_CALLER_ADDRESS _ReturnAddress()
+#else
+ #define ONEXOSC_CALLER_ADDRESS __builtin_return_address (0)
+#endif
+
+namespace AudioThreadGuard
+{
+    namespace
+    {
+        struct Record
+        {
+            Kind kind;
+            const char* scopeName;
+            const char* file;
+            int line;
+            const void* caller;
+        };
+
+        constexpr int maxRecords = 256;
+        constexpr int maxAllowedLocks = 8;
+
+        std::array<Record, maxRecords> records;
+        std::atomic<int> numRecords { 0 };
+        std::atomic<int> numViolations { 0 };
+        std::atomic<Mode> mode { Mode::count };
+
+        std::array<std::atomic<const void*>, maxAllowedLocks> allowedLocks {};
+
+        thread_local const Scope* currentScope = nullptr;
+        thread_local int allowDepth = 0;
+        thread_local bool isReporting = false;
+
+        const char* getKindName (Kind kind)
+        {
+            switch (kind)
+            {
+                case Kind::allocation:   return "allocation";
+                case Kind::deallocation: return "deallocation";
+                case Kind::lock:         return "mutex lock";
+                case Kind::blockingCall: return "blocking call";
+                default:                 return "?";
+            }
+        }
+
+        juce::String describeAddress (const void* address)
+        {
+            auto text = juce::String::toHexString ((juce::pointer_sized_int) address);
+
+           #if JUCE_LINUX || JUCE_MAC
+            Dl_info info;
+
+            if (dladdr (address, &info) != 0 && info.dli_sname != nullptr)
+                text << " (" << info.dli_sname << ")";
+           #endif
+
+            return "0x" + text;
+        }
+    }
+
+    void setMode (Mode newMode) noexcept   { mode = newMode; }
+    Mode getMode() noexcept                { return mode.load(); }
+
+    int getNumViolations() noexcept        { return numViolations.load(); }
+
+    void resetViolations() noexcept
+    {
+        numRecords = 0;
+        numViolations = 0;
+    }
+
+    bool isInsideAudioThreadScope() noexcept
+    {
+        return currentScope != nullptr && allowDepth == 0;
+    }
+
+    void allowLock (const void* mutex) noexcept
+    {
+        for (auto& slot : allowedLocks)
+        {
+            const void* expected = nullptr;
+
+            if (slot.load() == mutex || slot.compare_exchange_strong (expected, mutex))
+                return;
+        }
+
+        jassertfalse; // more accepted locks than slots
+    }
+
+    bool isLockAllowed (const void* mutex) noexcept
+    {
+        for (auto& slot : allowedLocks)
+            if (slot.load() == mutex)
+                return true;
+
+        return false;
+    }
+
+    void reportViolation (Kind kind, const void* caller) noexcept
+    {
+        if (isReporting || ! isInsideAudioThreadScope() || mode.load() == Mode::off)
+            return;
+
+        isReporting = true;
+        ++numViolations;
+
+        const auto index = numRecords.fetch_add (1);
+
+        if (index < maxRecords)
+            records[(size_t) index] = { kind, currentScope->name, currentScope->file, currentScope->line, caller };
+
+        if (mode.load() == Mode::trap)
+        {
+            if (juce::Process::isRunningUnderDebugger())
+            {
+                JUCE_BREAK_IN_DEBUGGER;
+            }
+            else
+            {
+                std::abort();
+            }
+        }
+
+        isReporting = false;
+    }
+
+    juce::String getReport()
+    {
+        const ScopedAllow allow;
+
+        juce::String report;
+        const auto total = numViolations.load();
+        const auto stored = juce::jmin (numRecords.load(), maxRecords);
+
+        report << total << " audio thread violation(s)";
+
+        if (stored < total)
+            report << ", first " << stored << " listed";
+
+        report << juce::newLine;
+
+        for (int i = 0; i < stored; ++i)
+        {
+            const auto& r = records[(size_t) i];
+
+            report << "  " << getKindName (r.kind)
+                   << " in " << r.scopeName
+                   << " (" << juce::File::createFileWithoutCheckingPath (r.file).getFileName() << ":" << r.line << ")"
+                   << " from " << describeAddress (r.caller)
+                   << juce::newLine;
+        }
+
+        return report;
+    }
+
+    //==============================================================================
+    Scope::Scope (const char* scopeName, const char* sourceFile, int sourceLine) noexcept
+        : name (scopeName), file (sourceFile), line (sourceLine), previous (currentScope)
+    {
+        currentScope = this;
+    }
+
+    Scope::~Scope() noexcept
+    {
+        currentScope = previous;
+    }
+
+    ScopedAllow::ScopedAllow() noexcept    { ++allowDepth; }
+    ScopedAllow::~ScopedAllow() noexcept   { --allowDepth; }
+}
+
+//==============================================================================
+#if ONEXOSC_AUDIO_THREAD_GUARD
+
+using AudioThreadGuard::Kind;
+
+#if ONEXOSC_GUARD_INTERPOSE_LIBC
+
+// On glibc everything ends up in malloc, so that's where allocations are caught.
+// The real implementations are reached through the __libc_ aliases (for the
+// allocator) or dlsym (for the rest), which doesn't recurse into the hooks.
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void  __libc_free (void*);
+
+    void* malloc (size_t size) noexcept
+    {
+        AudioThreadGuard::reportViolation (Kind::allocation, ONEXOSC_CALLER_ADDRESS);
+        return __libc_malloc (size);
+    }
+
+    void* calloc (size_t num, size_t size) noexcept
+    {
+        AudioThreadGuard::reportViolation (Kind::allocation, ONEXOSC_CALLER_ADDRESS);
+        return __libc_calloc (num, size);
+    }
+
+    void* realloc (void* ptr, size_t size) noexcept
+    {
+        AudioThreadGuard::reportViolation (Kind::allocation, ONEXOSC_CALLER_ADDRESS);
+        return __libc_realloc (ptr, size);
+    }
+
+    void free (void* ptr) noexcept
+    {
+        if (ptr != nullptr)
+            AudioThreadGuard::reportViolation (Kind::deallocation, ONEXOSC_CALLER_ADDRESS);
+
+        __libc_free (ptr);
+    }
+}
+
+namespace
+{
+    template <typename FunctionType>
+    FunctionType getNextSymbol (std::atomic<FunctionType>& cache, const char* name) noexcept
+    {
+        auto fn = cache.load (std::memory_order_relaxed);
+
+        if (fn == nullptr)
+        {
+            fn = reinterpret_cast<FunctionType> (dlsym (RTLD_NEXT, name));
+            cache.store (fn, std::memory_order_relaxed);
+        }
+
+        return fn;
+    }
+}
+
+extern "C"
+{
+    int pthread_mutex_lock (pthread_mutex_t* mutex) noexcept
+    {
+        static std::atomic<int (*) (pthread_mutex_t*)> next { nullptr };
+
+        if (AudioThreadGuard::isInsideAudioThreadScope() && ! AudioThreadGuard::isLockAllowed (mutex))
+            AudioThreadGuard::reportViolation (Kind::lock, ONEXOSC_CALLER_ADDRESS);
+
+        return getNextSymbol (next, "pthread_mutex_lock") (mutex);
+    }
+
+    int pthread_cond_wait (pthread_cond_t* cond, pthread_mutex_t* mutex)
+    {
+        static std::atomic<int (*) (pthread_cond_t*, pthread_mutex_t*)> next { nullptr };
+        AudioThreadGuard::reportViolation (Kind::blockingCall, ONEXOSC_CALLER_ADDRESS);
+        return getNextSymbol (next, "pthread_cond_wait") (cond, mutex);
+    }
+
+    int pthread_cond_timedwait (pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* abstime)
+    {
+        static std::atomic<int (*) (pthread_cond_t*, pthread_mutex_t*, const struct timespec*)> next { nullptr };
+        AudioThreadGuard::reportViolation (Kind::blockingCall, ONEXOSC_CALLER_ADDRESS);
+        return getNextSymbol (next, "pthread_cond_timedwait") (cond, mutex, abstime);
+    }
+
+    int nanosleep (const struct timespec* duration, struct timespec* remaining)
+    {
+        static std::atomic<int (*) (const struct timespec*, struct timespec*)> next { nullptr };
+        AudioThreadGuard::reportViolation (Kind::blockingCall, ONEXOSC_CALLER_ADDRESS);
+        return getNextSymbol (next, "nanosleep") (duration, remaining);
+    }
+
+    int usleep (useconds_t microseconds)
+    {
+        static std::atomic<int (*) (useconds_t)> next { nullptr };
+        AudioThreadGuard::reportViolation (Kind::blockingCall, ONEXOSC_CALLER_ADDRESS);
+        return getNextSymbol (next, "usleep") (microseconds);
+    }
+}
+
+#else
+
+// Everywhere else we can at least see C++ allocations
+void* operator new (size_t size)
+{
+    AudioThreadGuard::reportViolation (Kind::allocation, ONEXOSC_CALLER_ADDRESS);
+
+    if (auto* ptr = std::malloc (size == 0 ? 1 : size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (size_t size)
+{
+    AudioThreadGuard::reportViolation (Kind::allocation, ONEXOSC_CALLER_ADDRESS);
+
+    if (auto* ptr = std::malloc (size == 0 ? 1 : size))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new (size_t size, const std::nothrow_t&) noexcept
+{
+    AudioThreadGuard::reportViolation (Kind::allocation, ONEXOSC_CALLER_ADDRESS);
+    return std::malloc (size == 0 ? 1 : size);
+}
+
+void* operator new[] (size_t size, const std::nothrow_t&) noexcept
+{
+    AudioThreadGuard::reportViolation (Kind::allocation, ONEXOSC_CALLER_ADDRESS);
+    return std::malloc (size == 0 ? 1 : size);
+}
+
+void operator delete (void* ptr) noexcept
+{
+    if (ptr != nullptr)
+        AudioThreadGuard::reportViolation (Kind::deallocation, ONEXOSC_CALLER_ADDRESS);
+
+    std::free (ptr);
+}
+
+void operator delete[] (void* ptr) noexcept
+{
+    if (ptr != nullptr)
+        AudioThreadGuard::reportViolation (Kind::deallocation, ONEXOSC_CALLER_ADDRESS);
+
+    std::free (ptr);
+}
+
+void operator delete (void* ptr, size_t) noexcept     { operator delete (ptr); }
+void operator delete[] (void* ptr, size_t) noexcept   { operator delete[] (ptr); }
+
+#endif
+
+#endif
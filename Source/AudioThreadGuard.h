@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    AudioThreadGuard.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Opt-in real-time safety checker for debug and test builds.
+//
+// Build with ONEXOSC_AUDIO_THREAD_GUARD=1 and every heap allocation, mutex lock
+// or sleeping call made on a thread that's inside an ONEXOSC_AUDIO_THREAD_SCOPE
+// is recorded together with the innermost scope (name, file, line) and the
+// calling address. Depending on the mode it's either counted or it stops the
+// program right there.
+//
+// What gets caught:
+//  - operator new / delete everywhere,
+//  - malloc / calloc / realloc / free, pthread mutex and condition variable
+//    waits and the sleep family on Linux/glibc, as long as the guard is linked
+//    into an executable (the Standalone app or the command line tools). Inside
+//    a plugin loaded by a host those calls bind to the host's libc first.
+//
+// With the flag off all of this compiles away.
+#ifndef ONEXOSC_AUDIO_THREAD_GUARD
+ #define ONEXOSC_AUDIO_THREAD_GUARD 0
+#endif
+
+namespace AudioThreadGuard
+{
+    enum class Mode
+    {
+        off,    // scopes are tracked but nothing is checked
+        count,  // violations are recorded, see getNumViolations() / getReport()
+        trap    // the first violation breaks into the debugger, or aborts when there isn't one
+    };
+
+    enum class Kind
+    {
+        allocation,
+        deallocation,
+        lock,
+        blockingCall
+    };
+
+    void setMode (Mode newMode) noexcept;
+    Mode getMode() noexcept;
+
+    // Total number of violations since the last reset (not just the stored ones)
+    int getNumViolations() noexcept;
+    void resetViolations() noexcept;
+
+    // One line per stored violation. Not real-time safe: call it once the audio
+    // has stopped, e.g. at the end of a benchmark run.
+    juce::String getReport();
+
+    // Called by the interposed functions; may also be called by hand before
+    // doing something that's known to block.
+    void reportViolation (Kind kind, const void* caller) noexcept;
+
+    bool isInsideAudioThreadScope() noexcept;
+
+    // Locks that are known and accepted on the audio thread (e.g. the one
+    // juce::Synthesiser takes around every render) can be excluded by address.
+    void allowLock (const void* mutex) noexcept;
+    bool isLockAllowed (const void* mutex) noexcept;
+
+    // Marks the current thread as an audio thread while it's alive. Nests; the
+    // innermost scope is what a violation gets attributed to.
+    class Scope
+    {
+    public:
+        Scope (const char* name, const char* file, int line) noexcept;
+        ~Scope() noexcept;
+
+        const char* const name;
+        const char* const file;
+        const int line;
+        const Scope* const previous;
+
+        JUCE_DECLARE_NON_COPYABLE (Scope)
+    };
+
+    // Temporarily suspends checking on this thread, for code that's known to
+    // be unsafe and is dealt with elsewhere.
+    class ScopedAllow
+    {
+    public:
+        ScopedAllow() noexcept;
+        ~ScopedAllow() noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedAllow)
+    };
+}
+
+#if ONEXOSC_AUDIO_THREAD_GUARD
+ #define ONEXOSC_AUDIO_THREAD_SCOPE(name)   AudioThreadGuard::Scope JUCE_JOIN_MACRO (audioThreadScope_, __LINE__) (name, __FILE__, __LINE__)
+ #define ONEXOSC_AUDIO_THREAD_ALLOW()       AudioThreadGuard::ScopedAllow JUCE_JOIN_MACRO (audioThreadAllow_, __LINE__)
+#else
+ #define ONEXOSC_AUDIO_THREAD_SCOPE(name)
+ #define ONEXOSC_AUDIO_THREAD_ALLOW()
+#endif
@@ -0,0 +1,298 @@
+/*
+  ==============================================================================
+
+    BlockEnvelope.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+// ADSR envelope that renders a whole block at a time, with curved segments.
+//
+// Each segment is an exponential approach towards a point just past its
+// target (the classic analogue-style envelope), so it ends in a finite time.
+// The curve setting decides how far past: 0 is practically a straight line,
+// 1 is strongly exponential. Segments are always exactly as long as their
+// time setting, release included, wherever it starts from.
+//
+// Rendering works out how many samples are left in the current segment and
+// fills them in one go, using the closed form of the curve so the loop has no
+// sample-to-sample dependency closer than 4 and vectorises. Sustain and idle
+// stretches are a plain fill.
+class BlockEnvelope
+{
+public:
+    struct Parameters
+    {
+        float attack = 0.1f;        // seconds
+        float decay = 0.1f;         // seconds
+        float sustain = 1.0f;       // level
+        float release = 0.1f;       // seconds
+
+        float attackCurve = 0.3f;   // 0 = linear, 1 = very exponential
+        float decayCurve = 0.7f;
+        float releaseCurve = 0.7f;
+    };
+
+    void setSampleRate (double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+        updateRates();
+    }
+
+    void setParameters (const Parameters& newParameters) noexcept
+    {
+        parameters = newParameters;
+        updateRates();
+    }
+
+    const Parameters& getParameters() const noexcept    { return parameters; }
+
+    void noteOn() noexcept
+    {
+        // from wherever it is now, so a retrigger doesn't click
+        state = attackSamples > 0.0 ? State::attack : State::decay;
+
+        if (state == State::decay)
+            value = 1.0f;
+
+        startDecayIfNeeded();
+    }
+
+    void noteOff() noexcept
+    {
+        if (state == State::idle)
+            return;
+
+        if (releaseSamples <= 0.0 || value <= 0.0f)
+        {
+            reset();
+            return;
+        }
+
+        // the release takes the full release time from the current level
+        releaseCoefficient = segmentCoefficient (value, releaseRatio, releaseSamples);
+        state = State::release;
+    }
+
+    // A release over the given time instead of the patch's, e.g. to get a
+    // stolen voice out of the way without a click
+    void quickRelease (double seconds) noexcept
+    {
+        if (state == State::idle)
+            return;
+
+        const auto samples = sampleRate * seconds;
+
+        if (samples < 1.0 || value <= 0.0f)
+        {
+            reset();
+            return;
+        }
+
+        releaseCoefficient = segmentCoefficient (value, releaseRatio, samples);
+        state = State::release;
+    }
+
+    void reset() noexcept
+    {
+        state = State::idle;
+        value = 0.0f;
+    }
+
+    bool isActive() const noexcept      { return state != State::idle; }
+    float getCurrentValue() const noexcept  { return value; }
+
+    // True if everything the last render() produced was one constant value
+    // (sustain or silence), so consumers can skip per-sample work on it.
+    bool wasLastBlockConstant() const noexcept  { return lastBlockConstant; }
+
+    // Writes the next numSamples envelope values to dest. Returns how many of
+    // them came before the envelope finished (numSamples while it's still
+    // going); the rest are 0.
+    int render (float* dest, int numSamples) noexcept
+    {
+        lastBlockConstant = state == State::sustain || state == State::idle;
+        int done = 0;
+
+        while (done < numSamples)
+        {
+            const int remaining = numSamples - done;
+
+            switch (state)
+            {
+                case State::idle:
+                    std::fill (dest + done, dest + numSamples, 0.0f);
+                    return done;
+
+                case State::sustain:
+                    value = parameters.sustain;
+                    std::fill (dest + done, dest + numSamples, value);
+                    return numSamples;
+
+                case State::attack:
+                {
+                    const int n = renderSegment (dest + done, remaining, 1.0f, 1.0f + attackRatio, attackCoefficient);
+                    done += n;
+
+                    if (value >= 1.0f)
+                    {
+                        value = 1.0f;
+                        dest[done - 1] = value;
+                        state = State::decay;
+                        startDecayIfNeeded();
+                    }
+
+                    break;
+                }
+
+                case State::decay:
+                {
+                    const int n = renderSegment (dest + done, remaining, parameters.sustain,
+                                                 parameters.sustain - decayRatio, decayCoefficient);
+                    done += n;
+
+                    if (value <= parameters.sustain)
+                    {
+                        value = parameters.sustain;
+                        dest[done - 1] = value;
+                        state = State::sustain;
+                    }
+
+                    break;
+                }
+
+                case State::release:
+                {
+                    const int n = renderSegment (dest + done, remaining, 0.0f, -releaseRatio, releaseCoefficient);
+                    done += n;
+
+                    if (value <= 0.0f)
+                    {
+                        value = 0.0f;
+                        dest[done - 1] = value;
+                        state = State::idle;
+                    }
+
+                    break;
+                }
+            }
+        }
+
+        return numSamples;
+    }
+
+private:
+    enum class State
+    {
+        idle,
+        attack,
+        decay,
+        sustain,
+        release
+    };
+
+    // Renders towards target along value -> asymptote, stopping at the sample
+    // where target is reached or at the end of the block. The value after n
+    // samples is asymptote + (value - asymptote) * coefficient^n.
+    int renderSegment (float* dest, int numSamples, float target, float asymptote, double coefficient) noexcept
+    {
+        const float start = value - asymptote;
+        int n = numSamples;
+
+        if (coefficient < 1.0 && start != 0.0f)
+        {
+            const double toGo = std::log ((double) (target - asymptote) / (double) start) / std::log (coefficient);
+            n = (int) std::clamp (std::ceil (toGo), 1.0, (double) numSamples);
+        }
+
+        const auto c = (float) coefficient;
+        float offset = start;
+        const int head = std::min (n, 4);
+
+        for (int i = 0; i < head; ++i)
+        {
+            offset *= c;
+            dest[i] = asymptote + offset;
+        }
+
+        const float c4 = (c * c) * (c * c);
+
+        for (int i = head; i < n; ++i)
+            dest[i] = asymptote + (dest[i - 4] - asymptote) * c4;
+
+        value = dest[n - 1];
+
+        // the last step may land a hair short of the target because of rounding
+        if (n < numSamples || (target - asymptote) * (value - target) <= 0.0f)
+            value = target;
+
+        return n;
+    }
+
+    void startDecayIfNeeded() noexcept
+    {
+        if (state == State::decay)
+        {
+            if (decaySamples <= 0.0 || parameters.sustain >= 1.0f)
+            {
+                value = parameters.sustain;
+                state = State::sustain;
+            }
+        }
+    }
+
+    // Maps the 0-1 curve setting onto how far past its target a segment aims
+    static float curveToRatio (float curve) noexcept
+    {
+        const float c = std::clamp (curve, 0.0f, 1.0f);
+        return std::exp (std::log (100.0f) + c * (std::log (0.001f) - std::log (100.0f)));
+    }
+
+    // Per-sample coefficient for covering distance in numSamples
+    static double segmentCoefficient (float distance, float ratio, double numSamples) noexcept
+    {
+        return std::exp (-std::log ((distance + ratio) / ratio) / numSamples);
+    }
+
+    void updateRates() noexcept
+    {
+        attackSamples = sampleRate * parameters.attack;
+        decaySamples = sampleRate * parameters.decay;
+        releaseSamples = sampleRate * parameters.release;
+
+        attackRatio = curveToRatio (parameters.attackCurve);
+        decayRatio = curveToRatio (parameters.decayCurve);
+        releaseRatio = curveToRatio (parameters.releaseCurve);
+
+        // Attack and decay always cover the same distance, so their rates are
+        // fixed here and starting a note or a decay is just a state change
+        if (attackSamples > 0.0)
+            attackCoefficient = segmentCoefficient (1.0f, attackRatio, attackSamples);
+
+        if (decaySamples > 0.0 && parameters.sustain < 1.0f)
+            decayCoefficient = segmentCoefficient (1.0f - parameters.sustain, decayRatio, decaySamples);
+
+        if (state == State::decay)
+            startDecayIfNeeded();
+
+        if (state == State::release && releaseSamples > 0.0)
+            releaseCoefficient = segmentCoefficient (value, releaseRatio, releaseSamples);
+    }
+
+    Parameters parameters;
+    double sampleRate = 44100.0;
+
+    double attackSamples = 0.0, decaySamples = 0.0, releaseSamples = 0.0;
+    float attackRatio = 1.0f, decayRatio = 1.0f, releaseRatio = 1.0f;
+    double attackCoefficient = 0.0, decayCoefficient = 0.0, releaseCoefficient = 0.0;
+
+    State state = State::idle;
+    float value = 0.0f;
+    bool lastBlockConstant = true;
+};
@@ -0,0 +1,175 @@
+/*
+  ==============================================================================
+
+    ClapProcessor.cpp
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include <array>
+#include <cstring>
+
+#if ONEXOSC_CLAP
+
+#include <clap/clap.h>
+#include <clap-juce-extensions/clap-juce-extensions.h>
+
+// The processor of the CMake build (clap/CMakeLists.txt), for every format it
+// makes. Loaded as a CLAP, it offers the clap.thread-pool extension: a block
+// with enough voices asks the host to run one task per voice on its own
+// worker threads (clap_host_thread_pool::request_exec), and the host calls
+// back into the synth for each of them (clap_plugin_thread_pool::exec) before
+// the request returns. Hosts without a pool turn the request down, and so
+// does every other format, and the voices then render serially as usual.
+//
+// How the thread pool gets through clap-juce-extensions depends on the
+// checkout, and clap/CMakeLists.txt works it out into ONEXOSC_CLAP_THREAD_POOL:
+//
+//   1  the wrapper forwards the extension: supportsThreadPool() /
+//      threadPoolExec() on the plugin side, and requestThreadPoolExec on the
+//      host side (left empty when the host doesn't have a pool)
+//   2  the wrapper hands extensions it doesn't know to extension (id), and
+//      the processor answers clap.thread-pool with the raw CLAP struct; the
+//      host's side comes from getHost()
+//   0  neither (only with ONEXOSC_CLAP_ALLOW_SERIAL): a plain CLAP whose
+//      voices render serially
+#ifndef ONEXOSC_CLAP_THREAD_POOL
+ #define ONEXOSC_CLAP_THREAD_POOL 0
+#endif
+
+#if ONEXOSC_CLAP_THREAD_POOL == 1
+
+class _1xOscClapProcessor  : public _1xOscAudioProcessor,
+                             public clap_juce_extensions::clap_juce_audio_processor_capabilities,
+                             private OscSynthesiser::TaskRunner
+{
+public:
+    _1xOscClapProcessor()
+    {
+        setVoiceTaskRunner (this);
+    }
+
+    bool supportsThreadPool() const noexcept override    { return true; }
+
+    // The host's worker threads, while runTasks() waits
+    void threadPoolExec (uint32_t taskIndex) noexcept override
+    {
+        synth.runVoiceTask (static_cast<int> (taskIndex));
+    }
+
+private:
+    bool runTasks (int numTasks) noexcept override
+    {
+        return requestThreadPoolExec != nullptr
+            && requestThreadPoolExec (static_cast<uint32_t> (numTasks));
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (_1xOscClapProcessor)
+};
+
+#elif ONEXOSC_CLAP_THREAD_POOL == 2
+
+namespace
+{
+    // clap_plugin_thread_pool::exec gets the clap_plugin_t, which belongs to
+    // the wrapper and doesn't lead back to the processor. So each instance
+    // takes a slot, and the extension it hands out calls the exec made for
+    // that slot. Instances past the last slot render serially.
+    constexpr int numThreadPoolSlots = 64;
+
+    std::atomic<OscSynthesiser*> threadPoolSynths[numThreadPoolSlots] {};
+
+    template <int slot>
+    void execThreadPoolTask (const clap_plugin_t*, uint32_t taskIndex) noexcept
+    {
+        if (auto* s = threadPoolSynths[slot].load (std::memory_order_acquire))
+            s->runVoiceTask (static_cast<int> (taskIndex));
+    }
+
+    template <int... slots>
+    constexpr std::array<clap_plugin_thread_pool_t, sizeof... (slots)> makeThreadPoolExtensions (std::integer_sequence<int, slots...>)
+    {
+        return { clap_plugin_thread_pool_t { &execThreadPoolTask<slots> }... };
+    }
+
+    constexpr auto threadPoolExtensions = makeThreadPoolExtensions (std::make_integer_sequence<int, numThreadPoolSlots>());
+}
+
+class _1xOscClapProcessor  : public _1xOscAudioProcessor,
+                             public clap_juce_extensions::clap_juce_audio_processor_capabilities,
+                             private OscSynthesiser::TaskRunner
+{
+public:
+    _1xOscClapProcessor()
+    {
+        for (int i = 0; i < numThreadPoolSlots && slot < 0; ++i)
+        {
+            OscSynthesiser* none = nullptr;
+
+            if (threadPoolSynths[i].compare_exchange_strong (none, &synth))
+                slot = i;
+        }
+
+        setVoiceTaskRunner (this);
+    }
+
+    ~_1xOscClapProcessor() override
+    {
+        if (slot >= 0)
+            threadPoolSynths[slot].store (nullptr, std::memory_order_release);
+    }
+
+    const void* extension (const char* id) noexcept override
+    {
+        if (slot >= 0 && std::strcmp (id, CLAP_EXT_THREAD_POOL) == 0)
+            return &threadPoolExtensions[static_cast<size_t> (slot)];
+
+        return nullptr;
+    }
+
+    // The host's extensions are looked up on the main thread, ahead of the
+    // blocks that use them
+    void prepareToPlay (double sampleRate, int samplesPerBlock) override
+    {
+        host = getHost();
+        hostThreadPool = host != nullptr
+            ? static_cast<const clap_host_thread_pool_t*> (host->get_extension (host, CLAP_EXT_THREAD_POOL))
+            : nullptr;
+
+        _1xOscAudioProcessor::prepareToPlay (sampleRate, samplesPerBlock);
+    }
+
+private:
+    bool runTasks (int numTasks) noexcept override
+    {
+        return hostThreadPool != nullptr
+            && hostThreadPool->request_exec != nullptr
+            && hostThreadPool->request_exec (host, static_cast<uint32_t> (numTasks));
+    }
+
+    int slot = -1;
+    const clap_host_t* host = nullptr;
+    const clap_host_thread_pool_t* hostThreadPool = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (_1xOscClapProcessor)
+};
+
+#else
+
+class _1xOscClapProcessor  : public _1xOscAudioProcessor,
+                             public clap_juce_extensions::clap_juce_audio_processor_capabilities
+{
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (_1xOscClapProcessor)
+};
+
+#endif
+
+//==============================================================================
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
+{
+    return new _1xOscClapProcessor();
+}
+
+#endif
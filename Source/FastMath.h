@@ -0,0 +1,222 @@
+/*
+  ==============================================================================
+
+    FastMath.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Approximations of the transcendental functions used in the voice hot paths,
+// in three accuracy tiers:
+//
+//   draft    low-order polynomials, for live playback
+//   precise  higher-order polynomials, about as good as float gets
+//   exact    the standard library (evaluated in double), for bounces
+//
+// Measured maximum errors (float evaluation, 10^7 points across the range):
+//
+//                          draft          precise
+//   sin2pi (absolute)      6.8e-5         2.0e-7
+//   tan, 0 to 0.49 pi      3.7e-4 rel     6.6e-6 rel    (filter range: up to fs/2.04)
+//   exp2 (relative)        7.5e-5         1.7e-7
+//
+// Everything here is branch-free so the block versions vectorise (GCC at -O3
+// with no special flags; check with -fopt-info-vec). `1xOscRender bench`
+// measures the speed and errors on the machine it runs on.
+namespace FastMath
+{
+    enum class Accuracy
+    {
+        draft,
+        precise,
+        exact
+    };
+
+    namespace detail
+    {
+        // Polynomial fits (Lawson-weighted least squares, close to minimax).
+        // sin (2 pi r) = r * P (r^2) for |r| <= 1/4
+        inline float sinPolyDraft (float r) noexcept
+        {
+            const float r2 = r * r;
+            return r * (6.28128008f + r2 * (-41.0952429f + r2 * 73.5855168f));
+        }
+
+        inline float sinPolyPrecise (float r) noexcept
+        {
+            const float r2 = r * r;
+            return r * (6.28318516f + r2 * (-41.3416550f + r2 * (81.6010040f + r2 * (-76.5497811f + r2 * 39.5366979f))));
+        }
+
+        // 2^f for 0 <= f <= 1
+        inline float exp2PolyDraft (float f) noexcept
+        {
+            return 0.999925219f + f * (0.695833539f + f * (0.226067159f + f * 0.0780245200f));
+        }
+
+        inline float exp2PolyPrecise (float f) noexcept
+        {
+            return 0.999999925f + f * (0.693153073f + f * (0.240153617f + f * (0.0558263178f + f * (0.00898934040f + f * 0.00187757655f))));
+        }
+
+        // GCC won't vectorise a loop over std::floor, std::fmin, std::fmax or
+        // float to int casts unless -fno-trapping-math is on, and won't
+        // if-convert a ternary that picks between a constant and a computed
+        // value. These two stand in for them. (-ffast-math would fold the adds
+        // in roundToWhole away; the project doesn't use it.)
+
+        // Nearest whole number, ties to even, for |x| <= 2^22
+        inline float roundToWhole (float x) noexcept
+        {
+            constexpr float magic = 12582912.0f;    // 1.5 * 2^23
+            return (x + magic) - magic;
+        }
+
+        // condition ? a : b, as bit masks
+        inline float select (bool condition, float a, float b) noexcept
+        {
+            uint32_t aBits, bBits;
+            std::memcpy (&aBits, &a, sizeof (aBits));
+            std::memcpy (&bBits, &b, sizeof (bBits));
+
+            const auto mask = 0u - static_cast<uint32_t> (condition);
+            const auto bits = (aBits & mask) | (bBits & ~mask);
+
+            float result;
+            std::memcpy (&result, &bits, sizeof (result));
+            return result;
+        }
+
+        // Folds a phase (in cycles, up to 2^22 either way) onto [-1/4, 1/4]
+        // with the same sine
+        inline float foldPhase (float cycles) noexcept
+        {
+            const float r = cycles - roundToWhole (cycles);     // -1/2 to 1/2
+            const float a = std::fabs (r);
+            const float folded = a < 0.5f - a ? a : 0.5f - a;   // 0 to 1/4
+            return std::copysign (folded, r);
+        }
+    }
+
+    // sin (2 pi x): x is a phase in cycles, up to 2^22 either way (past that
+    // a float has no fraction left to take the sine of)
+    template <Accuracy accuracy>
+    inline float sin2pi (float x) noexcept
+    {
+        if constexpr (accuracy == Accuracy::exact)
+            return static_cast<float> (std::sin (6.283185307179586 * static_cast<double> (x)));
+        else if constexpr (accuracy == Accuracy::precise)
+            return detail::sinPolyPrecise (detail::foldPhase (x));
+        else
+            return detail::sinPolyDraft (detail::foldPhase (x));
+    }
+
+    template <Accuracy accuracy>
+    inline float sin (float radians) noexcept
+    {
+        if constexpr (accuracy == Accuracy::exact)
+            return static_cast<float> (std::sin (static_cast<double> (radians)));
+        else
+            return sin2pi<accuracy> (radians * 0.159154943f);
+    }
+
+    // tan for 0 <= x < pi / 2, e.g. the bilinear prewarp tan (pi fc / fs)
+    template <Accuracy accuracy>
+    inline float tan (float x) noexcept
+    {
+        if constexpr (accuracy == Accuracy::exact)
+        {
+            return static_cast<float> (std::tan (static_cast<double> (x)));
+        }
+        else
+        {
+            const float cycles = x * 0.159154943f;
+            return sin2pi<accuracy> (cycles) / sin2pi<accuracy> (cycles + 0.25f);
+        }
+    }
+
+    // 2^x, clamped to the normal float range
+    template <Accuracy accuracy>
+    inline float exp2 (float x) noexcept
+    {
+        if constexpr (accuracy == Accuracy::exact)
+        {
+            return static_cast<float> (std::exp2 (static_cast<double> (x)));
+        }
+        else
+        {
+            // Rounding x - 1/2 floors x, except that whole numbers can come
+            // out one low; then the fraction is 1, which the fits cover
+            constexpr float magic = 12582912.0f;
+            const float whole = detail::roundToWhole (x - 0.5f);
+            const float fraction = x - whole;                   // 0 to 1
+
+            // 2^whole straight into the exponent bits: whole + magic holds
+            // whole + 2^22 in its low mantissa bits
+            const float shifted = whole + magic;
+            uint32_t bits;
+            std::memcpy (&bits, &shifted, sizeof (bits));
+            bits = ((bits & 0x7fffffu) - 0x400000u + 127u) << 23;
+
+            float scale;
+            std::memcpy (&scale, &bits, sizeof (scale));
+
+            float result;
+
+            if constexpr (accuracy == Accuracy::precise)
+                result = scale * detail::exp2PolyPrecise (fraction);
+            else
+                result = scale * detail::exp2PolyDraft (fraction);
+
+            // Outside -126 to 127 the bits above are garbage
+            return detail::select (x < -126.0f, 1.17549435e-38f,
+                                   detail::select (x > 127.0f, 1.70141183e38f, result));
+        }
+    }
+
+    // pow (2, x): same thing as exp2, kept under the name the old code used
+    template <Accuracy accuracy>
+    inline float pow2 (float x) noexcept
+    {
+        return exp2<accuracy> (x);
+    }
+
+    // Frequency ratio of a pitch offset in semitones
+    template <Accuracy accuracy>
+    inline float semitonesToRatio (float semitones) noexcept
+    {
+        return exp2<accuracy> (semitones * (1.0f / 12.0f));
+    }
+
+    //==============================================================================
+    // Block versions: plain loops over the scalar functions above, written so
+    // the compiler turns them into SIMD code (no branches, no calls left after
+    // inlining except in the exact tier).
+    template <Accuracy accuracy>
+    inline void sin2pi (const float* phases, float* dest, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = sin2pi<accuracy> (phases[i]);
+    }
+
+    template <Accuracy accuracy>
+    inline void tan (const float* src, float* dest, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = tan<accuracy> (src[i]);
+    }
+
+    template <Accuracy accuracy>
+    inline void exp2 (const float* src, float* dest, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = exp2<accuracy> (src[i]);
+    }
+}
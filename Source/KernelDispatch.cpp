@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    KernelDispatch.cpp
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "KernelDispatch.h"
+
+namespace KernelDispatch
+{
+    namespace sse2      { const Table& getTable() noexcept; }
+   #if ONEXOSC_KERNEL_VARIANTS
+    namespace avx2      { const Table& getTable() noexcept; }
+    namespace avx512    { const Table& getTable() noexcept; }
+   #endif
+
+    namespace
+    {
+        // The environment can cap the choice; anything else means no cap
+        InstructionSet getLimit()
+        {
+            const auto name = juce::SystemStats::getEnvironmentVariable ("ONEXOSC_KERNELS", {}).trim().toLowerCase();
+
+            for (auto instructionSet : { InstructionSet::sse2, InstructionSet::avx2 })
+                if (name == getName (instructionSet))
+                    return instructionSet;
+
+            return InstructionSet::avx512;
+        }
+    }
+
+    bool isSupported (InstructionSet instructionSet) noexcept
+    {
+        switch (instructionSet)
+        {
+            case InstructionSet::sse2:
+                return true;
+
+           #if ONEXOSC_KERNEL_VARIANTS
+            // The builtins also check that the OS saves the wide registers,
+            // which the CPUID feature bits alone don't say
+            case InstructionSet::avx2:
+                return __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma");
+
+            case InstructionSet::avx512:
+                return isSupported (InstructionSet::avx2)
+                    && __builtin_cpu_supports ("avx512f") && __builtin_cpu_supports ("avx512vl")
+                    && __builtin_cpu_supports ("avx512dq") && __builtin_cpu_supports ("avx512bw");
+           #else
+            case InstructionSet::avx2:
+            case InstructionSet::avx512:
+                return false;
+           #endif
+        }
+
+        return false;
+    }
+
+    const Table& getTable (InstructionSet instructionSet) noexcept
+    {
+       #if ONEXOSC_KERNEL_VARIANTS
+        if (instructionSet == InstructionSet::avx512 && isSupported (InstructionSet::avx512))
+            return avx512::getTable();
+
+        if (instructionSet != InstructionSet::sse2 && isSupported (InstructionSet::avx2))
+            return avx2::getTable();
+       #else
+        juce::ignoreUnused (instructionSet);
+       #endif
+
+        return sse2::getTable();
+    }
+
+    const Table& get() noexcept
+    {
+        static const Table& table = getTable (getLimit());
+        return table;
+    }
+
+    const char* getName (InstructionSet instructionSet) noexcept
+    {
+        switch (instructionSet)
+        {
+            case InstructionSet::sse2:      return "sse2";
+            case InstructionSet::avx2:      return "avx2";
+            case InstructionSet::avx512:    return "avx512";
+        }
+
+        return "";
+    }
+}
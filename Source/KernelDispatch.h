@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    KernelDispatch.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "OscillatorKernels.h"
+#include "VoiceFilter.h"
+
+// The hot loops (oscillators, envelope gain, filter, mixdown) built once per
+// instruction set, with the best one the CPU has picked at startup.
+//
+// The plugin ships as one binary for the x86-64 baseline (SSE2). Each of
+// KernelDispatchSSE2/AVX2/AVX512.cpp compiles the same loops from
+// KernelDispatchVariant.h into its own namespace, the AVX ones with the
+// instruction set switched on for those functions only (so the rest of the
+// binary still runs anywhere). get() checks CPUID the first time it's called
+// and hands out the widest table the machine can run.
+//
+// The variants are only built for 64-bit x86 with GCC or Clang; everywhere
+// else (Apple silicon, MSVC) the baseline table is all there is. Setting the
+// environment variable ONEXOSC_KERNELS to sse2, avx2 or avx512 caps the choice,
+// to compare them on the same machine.
+#ifndef ONEXOSC_KERNEL_VARIANTS
+ #if JUCE_INTEL && JUCE_64BIT && (JUCE_GCC || JUCE_CLANG)
+  #define ONEXOSC_KERNEL_VARIANTS 1
+ #else
+  #define ONEXOSC_KERNEL_VARIANTS 0
+ #endif
+#endif
+
+namespace KernelDispatch
+{
+    enum class InstructionSet
+    {
+        sse2,
+        avx2,
+        avx512
+    };
+
+    constexpr int numAccuracies = 3;
+    constexpr int numShapes = static_cast<int> (OscillatorKernels::Shape::numShapes);
+
+    template <typename SampleType>
+    struct Kernels
+    {
+        // [accuracy][shape]
+        std::array<std::array<OscillatorKernels::Function<SampleType>, numShapes>, numAccuracies> oscillators {};
+
+        // block[i] *= envelope[i] * gain
+        void (*applyGain) (SampleType* block, const float* envelope, float gain, int numSamples) noexcept = nullptr;
+
+        // the filter with fixed coefficients, over a whole block
+        void (*filter) (VoiceFilter<SampleType>& voiceFilter, SampleType* block, int numSamples) noexcept = nullptr;
+
+        // dest[i] += source[i] * gain
+        void (*mix) (SampleType* dest, const SampleType* source, SampleType gain, int numSamples) noexcept = nullptr;
+
+        OscillatorKernels::Function<SampleType> getOscillator (OscillatorKernels::Shape shape, FastMath::Accuracy accuracy) const noexcept
+        {
+            return oscillators[static_cast<size_t> (accuracy)][static_cast<size_t> (shape)];
+        }
+    };
+
+    struct Table
+    {
+        InstructionSet instructionSet;
+        Kernels<float> floatKernels;
+        Kernels<double> doubleKernels;
+
+        template <typename SampleType>
+        const Kernels<SampleType>& get() const noexcept
+        {
+            if constexpr (std::is_same_v<SampleType, double>)
+                return doubleKernels;
+            else
+                return floatKernels;
+        }
+    };
+
+    // The table for this machine. Call it once off the audio thread first
+    // (the voices do, when they're made): that's when CPUID is read.
+    const Table& get() noexcept;
+
+    // Whether this build has the variant and this CPU can run it
+    bool isSupported (InstructionSet instructionSet) noexcept;
+
+    // The widest supported table up to the one asked for
+    const Table& getTable (InstructionSet instructionSet) noexcept;
+
+    const char* getName (InstructionSet instructionSet) noexcept;
+}
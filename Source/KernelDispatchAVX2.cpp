@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    KernelDispatchAVX2.cpp
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "KernelDispatch.h"
+
+#if ONEXOSC_KERNEL_VARIANTS
+
+// After every include, so only the kernels below are built for AVX2
+#if JUCE_CLANG
+ #pragma clang attribute push (__attribute__ ((target ("avx2,fma"))), apply_to = function)
+#else
+ #pragma GCC push_options
+ #pragma GCC target ("avx2,fma")
+#endif
+
+#define ONEXOSC_KERNEL_NAMESPACE avx2
+#define ONEXOSC_KERNEL_INSTRUCTION_SET avx2
+#include "KernelDispatchVariant.h"
+
+#if JUCE_CLANG
+ #pragma clang attribute pop
+#else
+ #pragma GCC pop_options
+#endif
+
+#endif
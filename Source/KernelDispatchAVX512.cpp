@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    KernelDispatchAVX512.cpp
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "KernelDispatch.h"
+
+#if ONEXOSC_KERNEL_VARIANTS
+
+// After every include, so only the kernels below are built for AVX-512
+#if JUCE_CLANG
+ #pragma clang attribute push (__attribute__ ((target ("avx512f,avx512vl,avx512dq,avx512bw,avx2,fma"))), apply_to = function)
+#else
+ #pragma GCC push_options
+ #pragma GCC target ("avx512f,avx512vl,avx512dq,avx512bw,avx2,fma")
+#endif
+
+#define ONEXOSC_KERNEL_NAMESPACE avx512
+#define ONEXOSC_KERNEL_INSTRUCTION_SET avx512
+#include "KernelDispatchVariant.h"
+
+#if JUCE_CLANG
+ #pragma clang attribute pop
+#else
+ #pragma GCC pop_options
+#endif
+
+#endif
@@ -0,0 +1,16 @@
+/*
+  ==============================================================================
+
+    KernelDispatchSSE2.cpp
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "KernelDispatch.h"
+
+// The baseline the rest of the plugin is built for (SSE2 on x86-64, NEON on
+// Apple silicon); always there
+#define ONEXOSC_KERNEL_NAMESPACE sse2
+#define ONEXOSC_KERNEL_INSTRUCTION_SET sse2
+#include "KernelDispatchVariant.h"
@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    KernelDispatchVariant.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+// No include guard: each KernelDispatch*.cpp includes this once, after
+// defining ONEXOSC_KERNEL_NAMESPACE and ONEXOSC_KERNEL_INSTRUCTION_SET and
+// switching its instruction set on.
+//
+// Every entry point is flattened, so the kernels and everything they call are
+// inlined into it and compiled for this variant's instruction set. That also
+// keeps the wider code out of the inline functions and templates the rest of
+// the plugin shares (those are instantiated by the headers, before the
+// instruction set is switched on, and stay baseline).
+#if ! defined (ONEXOSC_KERNEL_NAMESPACE) || ! defined (ONEXOSC_KERNEL_INSTRUCTION_SET)
+ #error "Define ONEXOSC_KERNEL_NAMESPACE and ONEXOSC_KERNEL_INSTRUCTION_SET first"
+#endif
+
+#if JUCE_GCC || JUCE_CLANG
+ #define ONEXOSC_KERNEL_ENTRY __attribute__ ((flatten))
+#else
+ #define ONEXOSC_KERNEL_ENTRY
+#endif
+
+namespace KernelDispatch::ONEXOSC_KERNEL_NAMESPACE
+{
+    template <OscillatorKernels::Shape shape, FastMath::Accuracy accuracy, typename SampleType>
+    ONEXOSC_KERNEL_ENTRY void oscillator (OscillatorKernels::State& state, SampleType* dest, int numSamples) noexcept
+    {
+        OscillatorKernels::Kernel<shape, accuracy>::template render<SampleType> (state, dest, numSamples);
+    }
+
+    template <typename SampleType>
+    ONEXOSC_KERNEL_ENTRY void applyGain (SampleType* block, const float* envelope, float gain, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            block[i] *= static_cast<SampleType> (envelope[i] * gain);
+    }
+
+    template <typename SampleType>
+    ONEXOSC_KERNEL_ENTRY void filter (VoiceFilter<SampleType>& voiceFilter, SampleType* block, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            block[i] = voiceFilter.processSample (block[i]);
+    }
+
+    template <typename SampleType>
+    ONEXOSC_KERNEL_ENTRY void mix (SampleType* dest, const SampleType* source, SampleType gain, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] += source[i] * gain;
+    }
+
+    template <typename SampleType, FastMath::Accuracy accuracy>
+    void addOscillators (Kernels<SampleType>& kernels) noexcept
+    {
+        using OscillatorKernels::Shape;
+        auto& row = kernels.oscillators[static_cast<size_t> (accuracy)];
+
+        row[static_cast<size_t> (Shape::sine)]      = &oscillator<Shape::sine, accuracy, SampleType>;
+        row[static_cast<size_t> (Shape::triangle)]  = &oscillator<Shape::triangle, accuracy, SampleType>;
+        row[static_cast<size_t> (Shape::saw)]       = &oscillator<Shape::saw, accuracy, SampleType>;
+        row[static_cast<size_t> (Shape::supersaw)]  = &oscillator<Shape::supersaw, accuracy, SampleType>;
+        row[static_cast<size_t> (Shape::square)]    = &oscillator<Shape::square, accuracy, SampleType>;
+        row[static_cast<size_t> (Shape::noise)]     = &oscillator<Shape::noise, accuracy, SampleType>;
+        row[static_cast<size_t> (Shape::wavetable)] = &oscillator<Shape::wavetable, accuracy, SampleType>;
+
+        static_assert (numShapes == 7, "Add the new shape here");
+    }
+
+    template <typename SampleType>
+    Kernels<SampleType> makeKernels() noexcept
+    {
+        Kernels<SampleType> kernels;
+        addOscillators<SampleType, FastMath::Accuracy::draft> (kernels);
+        addOscillators<SampleType, FastMath::Accuracy::precise> (kernels);
+        addOscillators<SampleType, FastMath::Accuracy::exact> (kernels);
+        kernels.applyGain = &applyGain<SampleType>;
+        kernels.filter = &filter<SampleType>;
+        kernels.mix = &mix<SampleType>;
+        return kernels;
+    }
+
+    const Table& getTable() noexcept
+    {
+        static const Table table { InstructionSet::ONEXOSC_KERNEL_INSTRUCTION_SET, makeKernels<float>(), makeKernels<double>() };
+        return table;
+    }
+}
+
+#undef ONEXOSC_KERNEL_ENTRY
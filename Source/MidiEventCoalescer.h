@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+    MidiEventCoalescer.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <bitset>
+
+// Pre-processes the incoming MIDI of one block before it reaches the synth.
+// juce::Synthesiser renders a sub-block between every pair of MIDI events, so
+// a dense stream (MIDI effects, generators) chops the block into hundreds of
+// tiny renders. This class:
+//  - snaps event times onto a grid of minimumSubBlockSize samples, so the synth
+//    never renders less than that between events,
+//  - drops controller / pitch wheel / pressure messages that are overwritten by
+//    a later message of the same kind within the same grid slot,
+//  - drops note-ons that are cancelled by a note-off of the same note inside
+//    the same grid slot (they would only ever produce a release tail).
+// Everything is done in preallocated storage, so it's safe on the audio thread
+// as long as the block doesn't exceed the capacity given to prepare().
+class MidiEventCoalescer
+{
+public:
+    struct Options
+    {
+        int minimumSubBlockSize = 1;    // sample-accurate
+        bool coalesceControllers = true;
+        bool dropZeroLengthNotes = true;
+    };
+
+    void prepare (int maximumEventsPerBlock)
+    {
+        capacity = juce::jmax (maximumEventsPerBlock, 16);
+        events.clear();
+        events.reserve ((size_t) capacity);
+        keep.clear();
+        keep.reserve ((size_t) capacity);
+        coalesced.ensureSize ((size_t) capacity * 8);
+    }
+
+    void setOptions (const Options& newOptions)
+    {
+        options = newOptions;
+        options.minimumSubBlockSize = juce::jmax (1, options.minimumSubBlockSize);
+    }
+
+    const Options& getOptions() const { return options; }
+
+    // Returns the number of events that were removed from the buffer.
+    int process (juce::MidiBuffer& midiMessages, int numSamples)
+    {
+        events.clear();
+
+        for (const auto metadata : midiMessages)
+        {
+            if ((int) events.size() >= capacity)
+                return 0; // too dense for our storage: leave the block untouched
+
+            const auto slot = juce::jlimit (0, juce::jmax (0, numSamples - 1), metadata.samplePosition)
+                                / options.minimumSubBlockSize;
+            events.push_back ({ metadata.data, metadata.numBytes, slot * options.minimumSubBlockSize, slot });
+        }
+
+        if (events.empty())
+            return 0;
+
+        keep.assign (events.size(), true);
+
+        if (options.coalesceControllers)
+            markRedundantControllers();
+
+        if (options.dropZeroLengthNotes)
+            markZeroLengthNotes();
+
+        coalesced.clear();
+        int removed = 0;
+
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            if (keep[i])
+                coalesced.addEvent (events[i].data, events[i].numBytes, events[i].samplePosition);
+            else
+                ++removed;
+        }
+
+        // Copied back rather than swapped: swapping would hand the host's buffer
+        // (whatever its capacity) to us for the next block. There are never more
+        // events than came in, so the host's buffer has room for them.
+        midiMessages.clear();
+        midiMessages.addEvents (coalesced, 0, -1, 0);
+        return removed;
+    }
+
+private:
+    struct Event
+    {
+        const juce::uint8* data;
+        int numBytes;
+        int samplePosition;
+        int slot;
+    };
+
+    static int getStatus (const Event& e)   { return e.numBytes > 0 ? (e.data[0] & 0xf0) : 0; }
+    static int getChannel (const Event& e)  { return e.numBytes > 0 ? (e.data[0] & 0x0f) : 0; }
+
+    static bool isNoteOn (const Event& e)   { return getStatus (e) == 0x90 && e.numBytes > 2 && e.data[2] != 0; }
+    static bool isNoteOff (const Event& e)  { return (getStatus (e) == 0x80 || getStatus (e) == 0x90) && e.numBytes > 2 && ! isNoteOn (e); }
+
+    // Key for messages where only the most recent value matters, or -1.
+    static int getControllerKey (const Event& e)
+    {
+        const auto channel = getChannel (e);
+
+        switch (getStatus (e))
+        {
+            case 0xb0: return e.numBytes > 2 ? channel * 130 + e.data[1] : -1;
+            case 0xd0: return channel * 130 + 128;   // channel pressure
+            case 0xe0: return channel * 130 + 129;   // pitch wheel
+            default:   return -1;
+        }
+    }
+
+    void markRedundantControllers()
+    {
+        // Walk backwards through each slot: the first controller of a kind we
+        // meet is the last one sent, and everything earlier of the same kind in
+        // that slot is superseded. A note event on the channel resets the scan,
+        // because e.g. a sustain pedal change before a note-off still matters.
+        int currentSlot = -1;
+
+        for (auto i = (int) events.size(); --i >= 0;)
+        {
+            const auto& e = events[(size_t) i];
+
+            if (e.slot != currentSlot)
+            {
+                seenControllers.reset();
+                currentSlot = e.slot;
+            }
+
+            if (isNoteOn (e) || isNoteOff (e))
+            {
+                const auto base = (size_t) getChannel (e) * 130;
+
+                for (size_t k = 0; k < 130; ++k)
+                    seenControllers.reset (base + k);
+
+                continue;
+            }
+
+            const auto key = getControllerKey (e);
+
+            if (key < 0)
+                continue;
+
+            if (seenControllers.test ((size_t) key))
+                keep[(size_t) i] = false;
+            else
+                seenControllers.set ((size_t) key);
+        }
+    }
+
+    void markZeroLengthNotes()
+    {
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            if (! keep[i] || ! isNoteOn (events[i]))
+                continue;
+
+            const auto channel = getChannel (events[i]);
+            const auto note = events[i].data[1];
+
+            for (size_t j = i + 1; j < events.size() && events[j].slot == events[i].slot; ++j)
+            {
+                const auto& other = events[j];
+
+                if (! keep[j] || getChannel (other) != channel || other.numBytes < 2 || other.data[1] != note)
+                    continue;
+
+                // The note-off is kept: if the same note was already held from
+                // an earlier block it still has to be released.
+                if (isNoteOff (other))
+                    keep[i] = false;
+
+                if (isNoteOn (other) || isNoteOff (other))
+                    break;
+            }
+        }
+    }
+
+    Options options;
+    int capacity = 0;
+
+    std::vector<Event> events;
+    std::vector<bool> keep;
+    std::bitset<16 * 130> seenControllers;
+
+    juce::MidiBuffer coalesced;
+};
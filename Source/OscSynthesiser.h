@@ -0,0 +1,273 @@
+/*
+  ==============================================================================
+
+    OscSynthesiser.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SineWaveVoice.h"
+#include "Tracer.h"
+
+// juce::Synthesiser with control over where each voice renders to.
+// Every voice renders into its own mono scratch block, which is then mixed into
+// the output with the voice's pan gains by the mix kernel for this CPU
+// (see KernelDispatch.h).
+// In multi-timbral mode a voice playing part N goes to that part's output bus
+// (if the host enabled it), otherwise everything lands in the main output.
+//
+// Both precisions go the same way: with a double-precision host the voices
+// render, filter and mix in double, with their own double scratch blocks.
+//
+// Given a TaskRunner (the CLAP build hands over the host's thread pool), a
+// block with enough active voices renders them as one task each, on whatever
+// threads the runner has, and then mixes them in voice order as usual, so the
+// output is the same as rendering them one after the other. Without a runner,
+// or when it turns the work down, the voices render serially.
+class OscSynthesiser : public juce::Synthesiser
+{
+public:
+    static constexpr int maxParts = 16;
+    
+    template <typename SampleType>
+    using PartOutputs = std::array<juce::AudioBuffer<SampleType>*, maxParts>;
+    
+    class TaskRunner
+    {
+    public:
+        virtual ~TaskRunner() = default;
+
+        // Has runVoiceTask called for every index below numTasks, in any order
+        // and on any threads, and returns once they've all finished. Returns
+        // false if it can't right now, without running any of them.
+        virtual bool runTasks (int numTasks) noexcept = 0;
+    };
+
+    // Message thread, while nothing is rendering. Blocks with fewer active
+    // voices than minVoices aren't worth splitting up and render serially.
+    void setTaskRunner (TaskRunner* newRunner, int minVoices = 4)
+    {
+        taskRunner = newRunner;
+        minVoicesForTasks = juce::jmax (1, minVoices);
+    }
+
+    // Called by the TaskRunner, from its own threads
+    void runVoiceTask (int taskIndex) noexcept
+    {
+        if (! juce::isPositiveAndBelow (taskIndex, numTasks))
+            return;
+
+        auto& task = tasks[(size_t) taskIndex];
+        ONEXOSC_TRACE_SCOPE_ID ("voice", task.voiceIndex);
+
+        task.rendered = taskUsesDouble ? task.voice->renderVoiceBlock (doubleVoiceScratch.getWritePointer (task.voiceIndex), taskNumSamples)
+                                       : task.voice->renderVoiceBlock (voiceScratch.getWritePointer (task.voiceIndex), taskNumSamples);
+    }
+
+    // Allocates the scratch blocks for the precision the host renders in
+    // (the other one is freed). Call after the voices have been added.
+    void prepare (int maximumBlockSize, bool useDoublePrecision = false)
+    {
+        const int numChannels = juce::jmax (1, getNumVoices());
+        const int numSamples = juce::jmax (1, maximumBlockSize);
+
+        voiceScratch.setSize (useDoublePrecision ? 0 : numChannels, useDoublePrecision ? 0 : numSamples);
+        doubleVoiceScratch.setSize (useDoublePrecision ? numChannels : 0, useDoublePrecision ? numSamples : 0);
+        voiceScratch.clear();
+        doubleVoiceScratch.clear();
+
+        tasks.resize ((size_t) getNumVoices());
+        numTasks = 0;
+    }
+
+    // Called by the processor at the start of every block. Entries may be
+    // nullptr (or have no channels) for parts whose bus is disabled.
+    template <typename SampleType>
+    void setPartOutputs (juce::AudioBuffer<SampleType>* const* outputs, int numOutputs)
+    {
+        auto& targets = getPartOutputs<SampleType>();
+
+        for (int i = 0; i < maxParts; ++i)
+            targets[(size_t) i] = i < numOutputs ? outputs[i] : nullptr;
+    }
+
+    void clearPartOutputs()
+    {
+        partOutputs.fill (nullptr);
+        doublePartOutputs.fill (nullptr);
+    }
+
+protected:
+    void renderVoices (juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples) override
+    {
+        renderVoicesInto (outputAudio, startSample, numSamples);
+    }
+
+    void renderVoices (juce::AudioBuffer<double>& outputAudio, int startSample, int numSamples) override
+    {
+        renderVoicesInto (outputAudio, startSample, numSamples);
+    }
+
+    template <typename SampleType>
+    void renderVoicesInto (juce::AudioBuffer<SampleType>& outputAudio, int startSample, int numSamples)
+    {
+        if (taskRunner != nullptr && renderVoicesAsTasks (outputAudio, startSample, numSamples))
+            return;
+
+        auto& scratchBuffer = getScratch<SampleType>();
+
+        for (int i = 0; i < voices.size(); ++i)
+        {
+            auto* voice = voices.getUnchecked (i);
+            auto* oscVoice = dynamic_cast<SineWaveVoice*> (voice);
+            auto& target = getOutputFor (oscVoice, outputAudio);
+
+            // Anything we don't have scratch space for takes the slow route
+            if (oscVoice == nullptr || i >= scratchBuffer.getNumChannels() || numSamples > scratchBuffer.getNumSamples())
+            {
+                voice->renderNextBlock (target, startSample, numSamples);
+                continue;
+            }
+
+            auto* scratch = scratchBuffer.getWritePointer (i);
+
+            if (! oscVoice->isVoiceActive())
+                continue;
+
+            ONEXOSC_TRACE_SCOPE_ID ("voice", i);
+
+            if (oscVoice->renderVoiceBlock (scratch, numSamples))
+            {
+                ONEXOSC_TRACE_SCOPE ("mix");
+                mixVoice (target, startSample, numSamples, scratch, oscVoice->getPanGains());
+            }
+        }
+    }
+
+    // Returns false, having rendered nothing, if the block should go the serial way
+    template <typename SampleType>
+    bool renderVoicesAsTasks (juce::AudioBuffer<SampleType>& outputAudio, int startSample, int numSamples)
+    {
+        auto& scratchBuffer = getScratch<SampleType>();
+
+        if (numSamples > scratchBuffer.getNumSamples() || voices.size() > scratchBuffer.getNumChannels()
+             || voices.size() > (int) tasks.size())
+            return false;
+
+        int numActive = 0;
+
+        for (int i = 0; i < voices.size(); ++i)
+        {
+            auto* oscVoice = dynamic_cast<SineWaveVoice*> (voices.getUnchecked (i));
+
+            if (oscVoice == nullptr)
+                return false;
+
+            if (oscVoice->isVoiceActive())
+                tasks[(size_t) numActive++] = { oscVoice, i, false };
+        }
+
+        if (numActive < minVoicesForTasks)
+            return false;
+
+        numTasks = numActive;
+        taskNumSamples = numSamples;
+        taskUsesDouble = std::is_same_v<SampleType, double>;
+
+        const bool ran = taskRunner->runTasks (numActive);
+        numTasks = 0;
+
+        if (! ran)
+            return false;
+
+        ONEXOSC_TRACE_SCOPE ("mix");
+
+        for (int t = 0; t < numActive; ++t)
+        {
+            const auto& task = tasks[(size_t) t];
+
+            if (task.rendered)
+                mixVoice (getOutputFor (task.voice, outputAudio), startSample, numSamples,
+                          scratchBuffer.getReadPointer (task.voiceIndex), task.voice->getPanGains());
+        }
+
+        return true;
+    }
+
+    template <typename SampleType>
+    juce::AudioBuffer<SampleType>& getOutputFor (const SineWaveVoice* voice, juce::AudioBuffer<SampleType>& mainOutput)
+    {
+        if (voice != nullptr)
+        {
+            auto* partOutput = getPartOutputs<SampleType>()[(size_t) juce::jlimit (0, maxParts - 1, voice->getPartIndex())];
+
+            if (partOutput != nullptr && partOutput->getNumChannels() > 0)
+                return *partOutput;
+        }
+
+        return mainOutput;
+    }
+
+    template <typename SampleType>
+    static void mixVoice (juce::AudioBuffer<SampleType>& target, int startSample, int numSamples,
+                          const SampleType* voiceSamples, SineWaveVoice::PanGains gains)
+    {
+        const auto numChannels = target.getNumChannels();
+        const auto mix = KernelDispatch::get().get<SampleType>().mix;
+
+        if (numChannels == 1)
+        {
+            mix (target.getWritePointer (0, startSample), voiceSamples, SampleType (1), numSamples);
+            return;
+        }
+
+        mix (target.getWritePointer (0, startSample), voiceSamples, static_cast<SampleType> (gains.left), numSamples);
+        mix (target.getWritePointer (1, startSample), voiceSamples, static_cast<SampleType> (gains.right), numSamples);
+
+        // anything past stereo just gets the unpanned voice, as before
+        for (int channel = 2; channel < numChannels; ++channel)
+            mix (target.getWritePointer (channel, startSample), voiceSamples, SampleType (1), numSamples);
+    }
+
+private:
+    template <typename SampleType>
+    PartOutputs<SampleType>& getPartOutputs() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doublePartOutputs;
+        else
+            return partOutputs;
+    }
+
+    template <typename SampleType>
+    juce::AudioBuffer<SampleType>& getScratch() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleVoiceScratch;
+        else
+            return voiceScratch;
+    }
+
+    PartOutputs<float> partOutputs {};
+    PartOutputs<double> doublePartOutputs {};
+    juce::AudioBuffer<float> voiceScratch;
+    juce::AudioBuffer<double> doubleVoiceScratch;
+
+    struct VoiceTask
+    {
+        SineWaveVoice* voice = nullptr;
+        int voiceIndex = 0;
+        bool rendered = false;
+    };
+
+    TaskRunner* taskRunner = nullptr;
+    int minVoicesForTasks = 4;
+    std::vector<VoiceTask> tasks;   // the active voices of the block being rendered
+    int numTasks = 0;
+    int taskNumSamples = 0;
+    bool taskUsesDouble = false;
+};
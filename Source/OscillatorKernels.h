@@ -0,0 +1,401 @@
+/*
+  ==============================================================================
+
+    OscillatorKernels.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include "FastMath.h"
+#include "Wavetable.h"
+
+// Block renderers for the oscillator shapes. Each shape is its own template
+// specialisation with a tight loop and no branching on the mode, so the
+// compiler can inline and vectorise it. A voice looks the kernel up once per
+// block through getKernel() instead of switching on the mode every sample.
+//
+// The phase is a 32-bit fixed-point fraction of a cycle: it wraps by itself on
+// overflow, so there's no fmod anywhere. Kernels that need sin / exp2 are also
+// specialised on the FastMath accuracy tier.
+namespace OscillatorKernels
+{
+    enum class Shape
+    {
+        sine,
+        triangle,
+        saw,
+        supersaw,
+        square,
+        noise,
+        wavetable,
+        numShapes
+    };
+
+    constexpr int numUnisonVoices = 7;
+    constexpr int maxPartials = 256;
+
+    struct State
+    {
+        uint32_t phase = 0;
+        uint32_t phaseIncrement = 0;
+        float special = 0.0f;
+
+        std::array<uint32_t, numUnisonVoices> unisonPhases {};
+        uint32_t noiseState = 0x9e3779b9u;
+
+        // Additive (Sine mode): harmonic h is partialLevels[h - 1] (the patch's
+        // spectrum, 1/h when there's none) times partialEnvelope[h - 1], which
+        // starts at 1 on a note-on and drops by partialDecay * (h - 1) (log2
+        // per sample) from there. special picks how many of the numPartials.
+        const float* partialLevels = nullptr;
+        int numPartials = 21;
+        float partialDecay = 0.0f;
+        std::array<float, maxPartials> partialEnvelope {};
+
+        // Quality limits (see QualityGovernor)
+        int maxHarmonics = maxPartials;
+        int numUnison = numUnisonVoices;
+
+        const Wavetable* wavetable = nullptr;
+
+        State() noexcept    { partialEnvelope.fill (1.0f); }
+    };
+
+    // 0 to 1 (never quite 1). Only the top 24 bits are used so the conversion is exact.
+    inline float phaseToFloat (uint32_t phase) noexcept
+    {
+        return static_cast<float> (phase >> 8) * (1.0f / 16777216.0f);
+    }
+
+    inline uint32_t frequencyToIncrement (double frequency, double sampleRate) noexcept
+    {
+        return sampleRate > 0.0 ? static_cast<uint32_t> (static_cast<int64_t> (frequency / sampleRate * 4294967296.0))
+                                : 0u;
+    }
+
+    using Accuracy = FastMath::Accuracy;
+
+    template <Shape shape, Accuracy accuracy>
+    struct Kernel;
+
+    // Additive: 1 + special * (numPartials - 1) harmonics, leaving out any at
+    // or above Nyquist.
+    //
+    // Only the fundamental's sin and cos are evaluated; every further harmonic
+    // comes from the Chebyshev recurrence
+    //     sin ((h + 1) x) = 2 cos (x) sin (h x) - sin ((h - 1) x)
+    // which is one multiply-add per harmonic and sample. It runs over chunks
+    // of samples with the samples innermost, so it vectorises.
+    //
+    // The recurrence magnifies any error in cos (x) with every harmonic, so the
+    // fundamental always comes from the precise polynomials (draft is too
+    // coarse at 256 harmonics) via the half angle, which keeps cos (x) <= 1 and
+    // accurate near 0. Measured against the direct sum at 256 equal partials:
+    // 4e-4 of the peak in float, 9e-6 in the exact tier (double recurrence).
+    template <Accuracy accuracy>
+    struct Kernel<Shape::sine, accuracy>
+    {
+        using Real = std::conditional_t<accuracy == Accuracy::exact, double, float>;
+        static constexpr Accuracy fundamentalAccuracy = accuracy == Accuracy::exact ? Accuracy::exact : Accuracy::precise;
+        static constexpr int chunkSize = 64;
+
+        template <typename SampleType>
+        static void render (State& state, SampleType* dest, int numSamples) noexcept
+        {
+            // harmonic h is below Nyquist while h * increment < 2^31
+            const auto belowNyquist = state.phaseIncrement > 0 ? 0x7fffffffu / state.phaseIncrement : 1u;
+            const int numHarmonics = std::max (1, std::min ({ static_cast<int> (1 + state.special * static_cast<float> (state.numPartials - 1)),
+                                                              state.maxHarmonics,
+                                                              static_cast<int> (std::min (belowNyquist, static_cast<uint32_t> (maxPartials))) }));
+
+            Real twoCos[chunkSize], previous[chunkSize], current[chunkSize], sum[chunkSize];
+
+            for (int start = 0; start < numSamples; start += chunkSize)
+            {
+                const int n = std::min (chunkSize, numSamples - start);
+
+                for (int i = 0; i < n; ++i)
+                {
+                    const float halfCycles = phaseToFloat (state.phase) * 0.5f;
+                    const auto s = static_cast<Real> (FastMath::sin2pi<fundamentalAccuracy> (halfCycles));
+                    const auto c = static_cast<Real> (FastMath::sin2pi<fundamentalAccuracy> (halfCycles + 0.25f));
+
+                    current[i] = 2 * s * c;         // sin (x)
+                    twoCos[i] = 2 - 4 * s * s;      // 2 cos (x)
+                    previous[i] = 0;                // sin (0 x)
+                    sum[i] = 0;
+                    state.phase += state.phaseIncrement;
+                }
+
+                for (int h = 1; h <= numHarmonics; ++h)
+                {
+                    if (h > 1)
+                    {
+                        for (int i = 0; i < n; ++i)
+                        {
+                            const auto next = twoCos[i] * current[i] - previous[i];
+                            previous[i] = current[i];
+                            current[i] = next;
+                        }
+                    }
+
+                    // the partial's level ramps across the chunk as its envelope moves
+                    const auto level = state.partialLevels != nullptr ? state.partialLevels[h - 1] : 1.0f / static_cast<float> (h);
+                    const auto envelope = state.partialEnvelope[(size_t) h - 1];
+                    const auto nextEnvelope = decayEnvelope (state, h, n);
+                    const auto gain = static_cast<Real> (level * envelope);
+                    const auto gainStep = static_cast<Real> (level * (nextEnvelope - envelope) / static_cast<float> (n));
+
+                    if (gain == 0 && gainStep == 0)
+                        continue;
+
+                    for (int i = 0; i < n; ++i)
+                        sum[i] += (gain + gainStep * static_cast<Real> (i)) * current[i];
+                }
+
+                for (int i = 0; i < n; ++i)
+                    dest[start + i] = static_cast<SampleType> (sum[i] * static_cast<Real> (0.5)); // basic normalisation
+
+                // the partials that weren't heard move on too, so turning
+                // special up later brings them in where they'd be anyway
+                if (state.partialDecay < 0.0f)
+                    for (int h = numHarmonics + 1; h <= state.numPartials; ++h)
+                        decayEnvelope (state, h, n);
+            }
+        }
+
+        // Moves harmonic h's envelope on by n samples and returns its new value
+        static float decayEnvelope (State& state, int h, int n) noexcept
+        {
+            auto& envelope = state.partialEnvelope[(size_t) h - 1];
+
+            if (state.partialDecay < 0.0f && h > 1)
+            {
+                envelope *= FastMath::exp2<Accuracy::precise> (state.partialDecay * static_cast<float> ((h - 1) * n));
+
+                if (envelope < 1.0e-6f)
+                    envelope = 0.0f;
+            }
+
+            return envelope;
+        }
+    };
+
+    // Desmos-based triangle with g = special, mimics the Arturia Minibrute metalizer
+    template <Accuracy accuracy>
+    struct Kernel<Shape::triangle, accuracy>
+    {
+        template <typename SampleType>
+        static void render (State& state, SampleType* dest, int numSamples) noexcept
+        {
+            const float g = state.special * 10.0f + 1.0f;
+            uint32_t phase = state.phase;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float t = std::abs (phaseToFloat (phase) - 0.5f) * 2.0f * g;
+                const float a = std::min (t, 1.0f) - std::max (t, 1.0f) + 1.0f;
+                dest[i] = std::abs (a) - 0.5f;
+                phase += state.phaseIncrement;
+            }
+
+            state.phase = phase;
+        }
+    };
+
+    template <Accuracy accuracy>
+    struct Kernel<Shape::saw, accuracy>
+    {
+        template <typename SampleType>
+        static void render (State& state, SampleType* dest, int numSamples) noexcept
+        {
+            uint32_t phase = state.phase;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                dest[i] = 2.0f * phaseToFloat (phase) - 1.0f;
+                phase += state.phaseIncrement;
+            }
+
+            state.phase = phase;
+        }
+    };
+
+    // Seven saws spread by up to +-1.5 semitones (special = 1). With fewer
+    // unison voices allowed, the outer ones are dropped first.
+    template <Accuracy accuracy>
+    struct Kernel<Shape::supersaw, accuracy>
+    {
+        template <typename SampleType>
+        static void render (State& state, SampleType* dest, int numSamples) noexcept
+        {
+            constexpr float detuneOffsets[numUnisonVoices] = { -3.0f, -2.0f, -1.0f, 0.0f, 1.0f, 2.0f, 3.0f };
+
+            for (int i = 0; i < numSamples; ++i)
+                dest[i] = 0.0f;
+
+            const int numVoices = std::clamp (state.numUnison, 1, numUnisonVoices);
+            const int firstVoice = (numUnisonVoices - numVoices) / 2;
+
+            for (int u = firstVoice; u < firstVoice + numVoices; ++u)
+            {
+                const float detune = detuneOffsets[u] * (state.special / 2.0f); // bring the range down a bit
+                const auto increment = static_cast<uint32_t> (static_cast<float> (state.phaseIncrement)
+                                                                * FastMath::semitonesToRatio<accuracy> (detune));
+                uint32_t phase = state.unisonPhases[(size_t) u];
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    dest[i] += 2.0f * phaseToFloat (phase) - 1.0f;
+                    phase += increment;
+                }
+
+                state.unisonPhases[(size_t) u] = phase;
+            }
+
+            for (int i = 0; i < numSamples; ++i)
+                dest[i] *= (1.0f / static_cast<float> (numVoices));
+
+            state.phase += state.phaseIncrement * static_cast<uint32_t> (numSamples);
+        }
+    };
+
+    // Pulse width modulation: centre = 0.5, range = 0.5 to 0.99
+    template <Accuracy accuracy>
+    struct Kernel<Shape::square, accuracy>
+    {
+        template <typename SampleType>
+        static void render (State& state, SampleType* dest, int numSamples) noexcept
+        {
+            const auto pulseWidth = static_cast<uint32_t> ((0.5 + state.special * 0.49) * 4294967295.0);
+            uint32_t phase = state.phase;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                dest[i] = phase < pulseWidth ? 1.0f : -1.0f;
+                phase += state.phaseIncrement;
+            }
+
+            state.phase = phase;
+        }
+    };
+
+    // xorshift32: cheap, and each voice has its own deterministic sequence
+    template <Accuracy accuracy>
+    struct Kernel<Shape::noise, accuracy>
+    {
+        template <typename SampleType>
+        static void render (State& state, SampleType* dest, int numSamples) noexcept
+        {
+            uint32_t x = state.noiseState;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                dest[i] = static_cast<float> (static_cast<int32_t> (x)) * (1.0f / 2147483648.0f);
+            }
+
+            state.noiseState = x;
+            state.phase += state.phaseIncrement * static_cast<uint32_t> (numSamples);
+        }
+    };
+
+    // User wavetable, special = frame position. Picks the mip level for the
+    // pitch once per block and crossfades between the two nearest frames.
+    // Plays a plain sine while there's no table (yet).
+    template <Accuracy accuracy>
+    struct Kernel<Shape::wavetable, accuracy>
+    {
+        template <typename SampleType>
+        static void render (State& state, SampleType* dest, int numSamples) noexcept
+        {
+            const auto* table = state.wavetable;
+            uint32_t phase = state.phase;
+
+            if (table == nullptr)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    dest[i] = FastMath::sin2pi<accuracy> (phaseToFloat (phase));
+                    phase += state.phaseIncrement;
+                }
+
+                state.phase = phase;
+                return;
+            }
+
+            const float position = std::clamp (state.special, 0.0f, 1.0f) * static_cast<float> (table->getNumFrames() - 1);
+            const int frameA = static_cast<int> (position);
+            const int frameB = std::min (frameA + 1, table->getNumFrames() - 1);
+            const float frameMix = position - static_cast<float> (frameA);
+
+            const int level = table->getLevelForIncrement (state.phaseIncrement);
+            const float* a = table->getFrame (frameA, level);
+            const float* b = table->getFrame (frameB, level);
+
+            const int shift = 32 - table->getLevelSizeBits (level);
+            const uint32_t fractionMask = (1u << shift) - 1u;
+            const float fractionScale = 1.0f / static_cast<float> (1u << shift);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto index = phase >> shift;
+                const float fraction = static_cast<float> (phase & fractionMask) * fractionScale;
+
+                const float sampleA = a[index] + fraction * (a[index + 1] - a[index]);
+                const float sampleB = b[index] + fraction * (b[index + 1] - b[index]);
+
+                dest[i] = sampleA + frameMix * (sampleB - sampleA);
+                phase += state.phaseIncrement;
+            }
+
+            state.phase = phase;
+        }
+    };
+
+    // Kernels write straight into the voice's float or double block
+    template <typename SampleType>
+    using Function = void (*) (State&, SampleType*, int) noexcept;
+
+    template <typename SampleType, Accuracy accuracy>
+    inline Function<SampleType> getKernel (Shape shape) noexcept
+    {
+        static constexpr Function<SampleType> table[] =
+        {
+            &Kernel<Shape::sine, accuracy>::template render<SampleType>,
+            &Kernel<Shape::triangle, accuracy>::template render<SampleType>,
+            &Kernel<Shape::saw, accuracy>::template render<SampleType>,
+            &Kernel<Shape::supersaw, accuracy>::template render<SampleType>,
+            &Kernel<Shape::square, accuracy>::template render<SampleType>,
+            &Kernel<Shape::noise, accuracy>::template render<SampleType>,
+            &Kernel<Shape::wavetable, accuracy>::template render<SampleType>
+        };
+
+        static_assert (std::size (table) == static_cast<size_t> (Shape::numShapes));
+        return table[static_cast<size_t> (shape)];
+    }
+
+    template <typename SampleType>
+    inline Function<SampleType> getKernel (Shape shape, Accuracy accuracy) noexcept
+    {
+        switch (accuracy)
+        {
+            case Accuracy::draft:   return getKernel<SampleType, Accuracy::draft> (shape);
+            case Accuracy::precise: return getKernel<SampleType, Accuracy::precise> (shape);
+            case Accuracy::exact:   return getKernel<SampleType, Accuracy::exact> (shape);
+        }
+
+        return getKernel<SampleType, Accuracy::exact> (shape);
+    }
+}
@@ -0,0 +1,167 @@
+/*
+  ==============================================================================
+
+    PatchSnapshot.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Plain copy of every parameter a voice needs. The processor reads one from the
+// APVTS each block (or one per part in multi-timbral mode) and the voices pick
+// up whatever changed from it.
+struct PatchSnapshot
+{
+    int waveform = 0;
+
+    float attack = 0.1f;
+    float decay = 0.1f;
+    float sustain = 1.0f;
+    float release = 0.1f;
+
+    float coarseTune = 0.0f;
+    float fineTune = 0.0f;
+    float special = 0.0f;
+
+    int filterType = 0;
+    float filterCutoff = 1000.0f;
+    float filterResonance = 1.0f;
+    float filterAttack = 0.1f;
+    float filterDecayRelease = 0.1f;
+    float filterSustain = 1.0f;
+    float filterAmount = 0.0f;
+
+    float level = 0.8f;
+    float stereoWidth = 0.0f;
+
+    int numPartials = 21;
+    float partialTilt = 1.0f;
+    float partialDecay = 0.0f;
+
+    bool wavetable = false;     // plays the user wavetable instead of the waveform
+
+    // Where some of them are in getParameterIDs(), for audio thread code that
+    // can't look them up (the first lookup would build the strings)
+    static constexpr int numParameters = 21;
+    static constexpr int levelIndex = 15;
+    static constexpr int stereoWidthIndex = 16;
+
+    // Parameter IDs in the same order as the fields above
+    static const juce::StringArray& getParameterIDs()
+    {
+        static const juce::StringArray ids { "waveform", "attack", "decay", "sustain", "release",
+                                             "coarseTune", "fineTune", "special",
+                                             "filterType", "filterCutoff", "filterResonance",
+                                             "filterAttack", "filterDecayRelease", "filterSustain",
+                                             "filterAmount", "level", "stereoWidth",
+                                             "partials", "partialTilt", "partialDecay", "wavetable" };
+        return ids;
+    }
+
+    float getValue (int index) const
+    {
+        switch (index)
+        {
+            case 0:  return (float) waveform;
+            case 1:  return attack;
+            case 2:  return decay;
+            case 3:  return sustain;
+            case 4:  return release;
+            case 5:  return coarseTune;
+            case 6:  return fineTune;
+            case 7:  return special;
+            case 8:  return (float) filterType;
+            case 9:  return filterCutoff;
+            case 10: return filterResonance;
+            case 11: return filterAttack;
+            case 12: return filterDecayRelease;
+            case 13: return filterSustain;
+            case 14: return filterAmount;
+            case 15: return level;
+            case 16: return stereoWidth;
+            case 17: return (float) numPartials;
+            case 18: return partialTilt;
+            case 19: return partialDecay;
+            case 20: return wavetable ? 1.0f : 0.0f;
+            default: return 0.0f;
+        }
+    }
+
+    void setValue (int index, float value)
+    {
+        switch (index)
+        {
+            case 0:  waveform = (int) value; break;
+            case 1:  attack = value; break;
+            case 2:  decay = value; break;
+            case 3:  sustain = value; break;
+            case 4:  release = value; break;
+            case 5:  coarseTune = value; break;
+            case 6:  fineTune = value; break;
+            case 7:  special = value; break;
+            case 8:  filterType = (int) value; break;
+            case 9:  filterCutoff = value; break;
+            case 10: filterResonance = value; break;
+            case 11: filterAttack = value; break;
+            case 12: filterDecayRelease = value; break;
+            case 13: filterSustain = value; break;
+            case 14: filterAmount = value; break;
+            case 15: level = value; break;
+            case 16: stereoWidth = value; break;
+            case 17: numPartials = (int) value; break;
+            case 18: partialTilt = value; break;
+            case 19: partialDecay = value; break;
+            case 20: wavetable = value >= 0.5f; break;
+            default: break;
+        }
+    }
+
+    // Cached raw-value pointers, so reading a snapshot on the audio thread is
+    // just a handful of atomic loads (no string lookups).
+    struct Source
+    {
+        void attachTo (juce::AudioProcessorValueTreeState& apvts)
+        {
+            const auto& ids = getParameterIDs();
+            jassert (ids.size() == numParameters && ids[levelIndex] == "level" && ids[stereoWidthIndex] == "stereoWidth");
+            values.clearQuick();
+
+            for (const auto& id : ids)
+                values.add (apvts.getRawParameterValue (id));
+        }
+
+        void read (PatchSnapshot& patch) const
+        {
+            for (int i = 0; i < values.size(); ++i)
+                patch.setValue (i, values.getUnchecked (i)->load());
+        }
+
+        juce::Array<std::atomic<float>*> values;
+    };
+
+    juce::ValueTree toValueTree (int partIndex) const
+    {
+        juce::ValueTree tree ("PART");
+        tree.setProperty ("index", partIndex, nullptr);
+
+        const auto& ids = getParameterIDs();
+
+        for (int i = 0; i < ids.size(); ++i)
+            tree.setProperty (ids[i], getValue (i), nullptr);
+
+        return tree;
+    }
+
+    void fromValueTree (const juce::ValueTree& tree)
+    {
+        const auto& ids = getParameterIDs();
+
+        for (int i = 0; i < ids.size(); ++i)
+            if (tree.hasProperty (ids[i]))
+                setValue (i, (float) tree.getProperty (ids[i]));
+    }
+};
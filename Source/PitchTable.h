@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    PitchTable.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Oscillator phase increments for a fractional MIDI pitch at one sample rate,
+// tabulated every 1/16 semitone and linearly interpolated in between (well
+// under a hundredth of a cent off). Covers every note plus the full coarse
+// and fine tuning range, so a note-on never has to call pow().
+//
+// The reference used when there's no table is incrementForPitch().
+class PitchTable
+{
+public:
+    static constexpr int lowestPitch = -48;
+    static constexpr int highestPitch = 176;
+    static constexpr int stepsPerSemitone = 16;
+
+    explicit PitchTable (double sampleRateToUse)
+        : sampleRate (sampleRateToUse)
+    {
+        const int numSteps = (highestPitch - lowestPitch) * stepsPerSemitone + 1;
+        increments.resize ((size_t) numSteps + 1);
+
+        for (int i = 0; i < numSteps; ++i)
+            increments[(size_t) i] = exactIncrement (lowestPitch + (double) i / stepsPerSemitone, sampleRate);
+
+        increments.back() = increments[(size_t) numSteps - 1];
+    }
+
+    double getSampleRate() const noexcept    { return sampleRate; }
+
+    // pitch = MIDI note number plus any tuning offset, in semitones
+    uint32_t getIncrement (double pitch) const noexcept
+    {
+        const double position = (std::clamp (pitch, (double) lowestPitch, (double) highestPitch) - lowestPitch) * stepsPerSemitone;
+        const auto index = static_cast<size_t> (position);
+        const double fraction = position - static_cast<double> (index);
+
+        return toIncrement (increments[index] + fraction * (increments[index + 1] - increments[index]));
+    }
+
+    static uint32_t incrementForPitch (double pitch, double sampleRate) noexcept
+    {
+        return toIncrement (exactIncrement (pitch, sampleRate));
+    }
+
+private:
+    static double exactIncrement (double pitch, double sampleRate) noexcept
+    {
+        return sampleRate > 0.0 ? 440.0 * std::pow (2.0, (pitch - 69.0) / 12.0) / sampleRate * 4294967296.0
+                                : 0.0;
+    }
+
+    static uint32_t toIncrement (double increment) noexcept
+    {
+        return static_cast<uint32_t> (static_cast<int64_t> (increment));
+    }
+
+    double sampleRate;
+    std::vector<double> increments;
+};
@@ -8,7 +8,9 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "BinaryData.h"     // JuceLibraryCode in the Projucer build, the 1xOscData target in the CMake one
 #include "SineWaveVoice.h"
+#include "Tracer.h"
 
 //==============================================================================
 _1xOscAudioProcessorEditor::_1xOscAudioProcessorEditor (_1xOscAudioProcessor& p)
@@ -119,6 +121,138 @@ _1xOscAudioProcessorEditor::_1xOscAudioProcessorEditor (_1xOscAudioProcessor& p)
     specialAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         audioProcessor.apvts, "special", specialSlider);
     
+    addSliderWithLabel(widthSlider, widthLabel, "Width");
+    widthAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.apvts, "stereoWidth", widthSlider);
+    
+    // Multi-timbral mode and the part the knobs are editing
+    multiTimbralButton.setButtonText("Multi");
+    multiTimbralButton.setToggleState(audioProcessor.isMultiTimbral(), juce::dontSendNotification);
+    addAndMakeVisible(multiTimbralButton);
+    
+    for (int part = 1; part <= OscSynthesiser::maxParts; ++part)
+        editPartBox.addItem("Part " + juce::String(part), part);
+    
+    editPartBox.setSelectedId(audioProcessor.getEditPart() + 1, juce::dontSendNotification);
+    editPartBox.setEnabled(audioProcessor.isMultiTimbral());
+    addAndMakeVisible(editPartBox);
+    
+    multiTimbralButton.onClick = [this]
+    {
+        audioProcessor.setMultiTimbral(multiTimbralButton.getToggleState());
+        editPartBox.setEnabled(audioProcessor.isMultiTimbral());
+    };
+    
+    editPartBox.onChange = [this]
+    {
+        audioProcessor.setEditPart(editPartBox.getSelectedId() - 1);
+    };
+    
+    // Plays the user wavetable instead of the waveform, and picks its file
+    wavetableToggle.setButtonText("Table");
+    addAndMakeVisible(wavetableToggle);
+    
+    wavetableAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+        audioProcessor.apvts, "wavetable", wavetableToggle);
+    
+    updateWavetableButton();
+    addAndMakeVisible(wavetableButton);
+    
+    wavetableButton.onClick = [this]
+    {
+        wavetableChooser = std::make_unique<juce::FileChooser>("Load a wavetable", audioProcessor.getWavetableFile(), "*.wav");
+        
+        wavetableChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                      [this] (const juce::FileChooser& chooser)
+        {
+            const auto file = chooser.getResult();
+            
+            if (file == juce::File())
+                return;
+            
+            const auto result = audioProcessor.loadWavetable(file);
+            
+            if (result.failed())
+                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Wavetable", result.getErrorMessage());
+            
+            updateWavetableButton();
+        });
+    };
+    
+    traceButton.setButtonText("Trace");
+    traceButton.setToggleState(Tracer::isRunning(), juce::dontSendNotification);
+    traceButton.setTooltip("Records what the audio thread spends its time on; switch off to save the trace (Chrome / Perfetto JSON) to the desktop");
+    addAndMakeVisible(traceButton);
+    
+    traceButton.onClick = [this]
+    {
+        if (traceButton.getToggleState())
+        {
+            Tracer::start();
+            return;
+        }
+        
+        Tracer::stop();
+        
+        const auto file = juce::File::getSpecialLocation(juce::File::userDesktopDirectory)
+                              .getNonexistentChildFile("1xOsc trace " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S"), ".json");
+        const auto result = Tracer::writeChromeTrace(file);
+        auto message = result.wasOk() ? "Saved to " + file.getFullPathName() : result.getErrorMessage();
+        
+        if (const auto untraced = Tracer::getNumUntracedThreads(); untraced > 0)
+            message << "\n" << untraced << " thread(s) weren't recorded (16 at most)";
+        
+        juce::AlertWindow::showMessageBoxAsync(result.wasOk() ? juce::MessageBoxIconType::InfoIcon : juce::MessageBoxIconType::WarningIcon,
+                                               "Trace", message);
+    };
+    
+    qualityButton.setButtonText("Auto Q");
+    qualityButton.setToggleState(audioProcessor.isAdaptiveQuality(), juce::dontSendNotification);
+    qualityButton.setTooltip("Lowers the quality step by step when the CPU can't keep up, and brings it back when it can");
+    addAndMakeVisible(qualityButton);
+    
+    qualityButton.onClick = [this]
+    {
+        audioProcessor.setAdaptiveQuality(qualityButton.getToggleState());
+    };
+    
+    qualityLabel.setJustificationType(juce::Justification::centredLeft);
+    qualityLabel.setFont(juce::Font(13.0f));
+    addAndMakeVisible(qualityLabel);
+    
+    sharedBudgetButton.setButtonText("Share");
+    sharedBudgetButton.setToggleState(audioProcessor.isSharedBudget(), juce::dontSendNotification);
+    addAndMakeVisible(sharedBudgetButton);
+    
+    sharedBudgetButton.onClick = [this]
+    {
+        audioProcessor.setSharedBudget(sharedBudgetButton.getToggleState());
+    };
+    
+    if (audioProcessor.canRenderAhead())
+    {
+        renderAheadBox.addItem("Direct", 1);
+        
+        for (const int numBlocks : { 2, 4, 8 })
+            renderAheadBox.addItem(juce::String(numBlocks) + " ahead", numBlocks + 1);
+        
+        renderAheadBox.setSelectedId(audioProcessor.getRenderAhead() + 1, juce::dontSendNotification);
+        renderAheadBox.setTooltip("Renders this many blocks ahead of the audio device: more latency, fewer dropouts");
+        addAndMakeVisible(renderAheadBox);
+        
+        renderAheadBox.onChange = [this]
+        {
+            audioProcessor.setRenderAhead(renderAheadBox.getSelectedId() - 1);
+        };
+        
+        renderAheadLabel.setJustificationType(juce::Justification::centredLeft);
+        renderAheadLabel.setFont(juce::Font(13.0f));
+        addAndMakeVisible(renderAheadLabel);
+    }
+    
+    timerCallback();
+    startTimerHz(4);
+    
     backgroundImage = juce::ImageCache::getFromMemory(BinaryData::OnexOsc_UI_Background_png, BinaryData::OnexOsc_UI_Background_pngSize);
 }
 
@@ -201,6 +335,64 @@ void _1xOscAudioProcessorEditor::resized()
     
     levelSlider.setBounds(300, adsrYOffset, 70, 70);
     levelLabel.setBounds(levelSlider.getX(), levelSlider.getBottom(), 70, 20);
+    
+    widthSlider.setBounds(380, adsrYOffset, 70, 70);
+    widthLabel.setBounds(widthSlider.getX(), widthSlider.getBottom(), 70, 20);
+    
+    multiTimbralButton.setBounds(370, 20, 60, 25);
+    editPartBox.setBounds(370, 50, 100, 25);
+    
+    wavetableToggle.setBounds(10, 72, 55, 18);
+    wavetableButton.setBounds(65, 72, 80, 18);
+    traceButton.setBounds(435, 20, 60, 25);
+    
+    qualityButton.setBounds(375, 80, 70, 22);
+    qualityLabel.setBounds(445, 80, 50, 22);
+    sharedBudgetButton.setBounds(10, 2, 60, 18);
+    renderAheadBox.setBounds(275, 1, 80, 18);
+    renderAheadLabel.setBounds(357, 1, 140, 18);
+}
+
+void _1xOscAudioProcessorEditor::updateWavetableButton()
+{
+    const auto file = audioProcessor.getWavetableFile();
+    wavetableButton.setButtonText(file == juce::File() ? "Load table..." : file.getFileNameWithoutExtension());
+    wavetableButton.setTooltip(file.getFullPathName());
+}
+
+void _1xOscAudioProcessorEditor::timerCallback()
+{
+    // a state loaded by the host can change these under us
+    multiTimbralButton.setToggleState(audioProcessor.isMultiTimbral(), juce::dontSendNotification);
+    editPartBox.setEnabled(audioProcessor.isMultiTimbral());
+    
+    if (! editPartBox.isPopupActive())
+        editPartBox.setSelectedId(audioProcessor.getEditPart() + 1, juce::dontSendNotification);
+    
+    const int level = audioProcessor.getQualityLevel();
+    
+    qualityLabel.setText(level == 0 ? "full" : "-" + juce::String(level), juce::dontSendNotification);
+    qualityLabel.setTooltip("Quality level " + juce::String(level) + " of " + juce::String(QualityGovernor::numLevels - 1)
+                            + ", DSP load " + juce::String(juce::roundToInt(audioProcessor.getDspLoad() * 100.0f)) + "%");
+    
+    const auto budget = audioProcessor.getSharedBudget().getBudget();
+    sharedBudgetButton.setTooltip("Shares " + juce::String(budget.maxVoices) + " voices and "
+                                  + juce::String(juce::roundToInt(budget.maxLoad * 100.0f)) + "% CPU with the other instances that have this on ("
+                                  + juce::String(audioProcessor.getSharedBudget().getNumActiveInstances()) + " playing now); the quietest give way first");
+    
+    if (renderAheadLabel.isVisible())
+    {
+        const int underruns = audioProcessor.getRenderAheadUnderruns();
+        const int dropped = audioProcessor.getRenderAheadDroppedEvents();
+        auto text = juce::String(underruns) + " xrun" + (underruns == 1 ? "" : "s");
+        
+        if (dropped > 0)
+            text << ", " << dropped << " MIDI lost";
+        
+        renderAheadLabel.setText(audioProcessor.getRenderAhead() > 0 ? text : "", juce::dontSendNotification);
+        renderAheadLabel.setTooltip("Blocks the device asked for before they were ready, and MIDI events that didn't fit in the queue "
+                                    "(controllers first, never note offs), since render-ahead was last switched on");
+    }
 }
 
 void _1xOscAudioProcessorEditor::sliderValueChanged(juce::Slider* slider)
@@ -12,7 +12,8 @@
 #include "PluginProcessor.h"
 
 class _1xOscAudioProcessorEditor : public juce::AudioProcessorEditor,
-                                    private juce::Slider::Listener
+                                    private juce::Slider::Listener,
+                                    private juce::Timer
 {
 public:
     _1xOscAudioProcessorEditor (_1xOscAudioProcessor&);
@@ -93,6 +94,38 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>
         filterAttackAttachment, filterDecayAttachment, filterSustainAttachment, filterReleaseAttachment;
     
+    // Stereo width
+    juce::Slider widthSlider;
+    juce::Label widthLabel;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> widthAttachment;
+    
+    // Multi-timbral mode
+    juce::ToggleButton multiTimbralButton;
+    juce::ComboBox editPartBox;
+    
+    // User wavetable
+    juce::ToggleButton wavetableToggle;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> wavetableAttachment;
+    juce::TextButton wavetableButton;
+    std::unique_ptr<juce::FileChooser> wavetableChooser;
+    void updateWavetableButton();
+    
+    // Records a timeline while it's on, saves it when it's switched off
+    juce::ToggleButton traceButton;
+    
+    // Adaptive quality on/off, and the level the governor is at right now
+    juce::ToggleButton qualityButton;
+    juce::Label qualityLabel;
+    
+    // Shared voice / CPU budget with the other instances on or off
+    juce::ToggleButton sharedBudgetButton;
+    
+    // Render-ahead (Standalone only): how many blocks, and the underruns and
+    // dropped MIDI so far
+    juce::ComboBox renderAheadBox;
+    juce::Label renderAheadLabel;
+    void timerCallback() override;
+    
     // Declare the ADSR logic
     void sliderValueChanged(juce::Slider* slider) override;
 
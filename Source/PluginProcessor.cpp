@@ -13,52 +13,52 @@
 
 #include "SineWaveSound.h"
 
+#include "AudioThreadGuard.h"
+
+#include "Tracer.h"
+
 //==============================================================================
 
 
 
-_1xOscAudioProcessor::_1xOscAudioProcessor()
-    : AudioProcessor (BusesProperties()
-                      #if ! JucePlugin_IsMidiEffect
-                       .withInput ("Input", juce::AudioChannelSet::stereo(), true)
-                      #endif
-                      .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
-                      #if JucePlugin_WantsMidiInput
-                      .withInput ("Midi Input", juce::AudioChannelSet::stereo(), true)
-                      #endif
-                      ),
-      apvts(*this, nullptr, "Parameters", createParameterLayout()) // Initialize APVTS
+juce::AudioProcessor::BusesProperties _1xOscAudioProcessor::createBusesProperties()
 {
+    auto buses = BusesProperties()
+                  #if ! JucePlugin_IsMidiEffect
+                   .withInput ("Input", juce::AudioChannelSet::stereo(), true)
+                  #endif
+                   .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                  #if JucePlugin_WantsMidiInput
+                   .withInput ("Midi Input", juce::AudioChannelSet::stereo(), true)
+                  #endif
+                   ;
     
-    // Parameter listeners
-    apvts.addParameterListener("waveform", this);
-    apvts.addParameterListener("coarseTune", this);
-    apvts.addParameterListener("fineTune", this);
+    // Optional outputs for parts 2-16 in multi-timbral mode (part 1 always uses
+    // the main output). Disabled unless the host turns them on.
+    for (int part = 2; part <= OscSynthesiser::maxParts; ++part)
+        buses = buses.withOutput ("Part " + juce::String(part), juce::AudioChannelSet::stereo(), false);
     
-    apvts.addParameterListener("attack", this);
-    apvts.addParameterListener("decay", this);
-    apvts.addParameterListener("sustain", this);
-    apvts.addParameterListener("release", this);
+    return buses;
+}
+
+_1xOscAudioProcessor::_1xOscAudioProcessor()
+    : AudioProcessor (createBusesProperties()),
+      apvts(*this, nullptr, "Parameters", createParameterLayout()) // Initialize APVTS
+{
+    patchSource.attachTo(apvts);
+    rebuildSounds();
     
-    apvts.addParameterListener("filterAttack", this);
-    apvts.addParameterListener("filterDecayRelease", this);
-    apvts.addParameterListener("filterSustain", this);
+   #if ONEXOSC_AUDIO_THREAD_GUARD
+    // juce::Synthesiser takes this around every render; it's only contended
+    // while sounds are swapped on the message thread
+    AudioThreadGuard::allowLock(&synth.getLock());
+   #endif
 }
 
 _1xOscAudioProcessor::~_1xOscAudioProcessor()
 {
-    apvts.removeParameterListener("waveform", this);
-    apvts.removeParameterListener("coarseTune", this);
-    apvts.removeParameterListener("fineTune", this);
-    
-    apvts.removeParameterListener("attack", this);
-    apvts.removeParameterListener("decay", this);
-    apvts.removeParameterListener("sustain", this);
-    apvts.removeParameterListener("release", this);
-    
-    apvts.removeParameterListener("filterAttack", this);
-    apvts.removeParameterListener("filterDecayRelease", this);
-    apvts.removeParameterListener("filterSustain", this);
+    // its thread renders with members declared after it
+    renderAhead.stop();
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout _1xOscAudioProcessor::createParameterLayout()
@@ -106,85 +106,27 @@ juce::AudioProcessorValueTreeState::ParameterLayout _1xOscAudioProcessor::create
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         "level", "Level", juce::NormalisableRange<float>(0.0f, 1.0f), 0.8f));
     
+    // Stereo spread of the voices (0 = mono)
+    params.push_back(std::make_unique<juce::AudioParameterFloat>(
+        "stereoWidth", "Stereo Width", juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
+    
+    // Additive (Sine mode): how many partials Special sweeps up to, how fast
+    // their levels fall with the harmonic number (1 = 1/h, a saw), and how
+    // much quicker the upper ones die away than the fundamental
+    params.push_back(std::make_unique<juce::AudioParameterInt>("partials", "Partials", 1, OscillatorKernels::maxPartials, 21));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("partialTilt", "Partial Tilt", juce::NormalisableRange<float>(0.0f, 3.0f), 1.0f));
+    params.push_back(std::make_unique<juce::AudioParameterFloat>("partialDecay", "Partial Decay", juce::NormalisableRange<float>(0.0f, 1.0f), 0.0f));
+    
+    // Plays the user wavetable in place of the waveform. A parameter of its own
+    // (and the last one, so hosts that go by index keep theirs): as a sixth
+    // waveform choice it moved the normalised value of every other choice,
+    // and with it the meaning of saved automation.
+    params.push_back(std::make_unique<juce::AudioParameterBool>("wavetable", "Wavetable", false));
+    
     return { params.begin(), params.end() };
 }
 
 //==============================================================================
-void _1xOscAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
-{
-    juce::Logger::writeToLog("parameterChanged called: " + parameterID);
-    if (parameterID == "waveform")
-    {
-        juce::Logger::writeToLog("Waveform changed: " + juce::String(newValue));
-        SineWaveVoice::OscillatorMode selectedMode = SineWaveVoice::OscillatorMode::Sine;
-
-        if (newValue == 0)
-            selectedMode = SineWaveVoice::OscillatorMode::Sine;
-        else if (newValue == 1)
-            selectedMode = SineWaveVoice::OscillatorMode::Triangle;
-        else if (newValue == 2)
-            selectedMode = SineWaveVoice::OscillatorMode::Saw;
-        else if (newValue == 3)
-            selectedMode = SineWaveVoice::OscillatorMode::Square;
-        else if (newValue == 4)
-            selectedMode = SineWaveVoice::OscillatorMode::Noise;
-        
-        for (int i = 0; i < synth.getNumVoices(); ++i)
-        {
-            if (auto* voice = dynamic_cast<SineWaveVoice*>(synth.getVoice(i)))
-                voice->setMode(selectedMode);
-        }
-    }
-    else if (parameterID == "coarseTune")
-    {
-        for (int i = 0; i < synth.getNumVoices(); ++i)
-        {
-            if (auto* voice = dynamic_cast<SineWaveVoice*>(synth.getVoice(i)))
-                voice->setCoarseTune(newValue);
-        }
-    }
-    else if (parameterID == "fineTune")
-    {
-        for (int i = 0; i < synth.getNumVoices(); ++i)
-        {
-            if (auto* voice = dynamic_cast<SineWaveVoice*>(synth.getVoice(i)))
-                voice->setFineTune(newValue);
-        }
-    }
-    else if (parameterID == "attack" || parameterID == "decay" ||
-             parameterID == "sustain" || parameterID == "release")
-    {
-        juce::ADSR::Parameters newParams;
-        newParams.attack  = apvts.getRawParameterValue("attack")->load();
-        newParams.decay   = apvts.getRawParameterValue("decay")->load();
-        newParams.sustain = apvts.getRawParameterValue("sustain")->load();
-        newParams.release = apvts.getRawParameterValue("release")->load();
-
-        for (int i = 0; i < synth.getNumVoices(); ++i)
-        {
-            if (auto* voice = dynamic_cast<SineWaveVoice*>(synth.getVoice(i)))
-                voice->setADSR(newParams);
-        }
-    }
-    
-    else if (parameterID == "filterAttack" || parameterID == "filterDecayRelease" ||
-             parameterID == "filterSustain")
-    {
-        juce::ADSR::Parameters filterParams;
-        filterParams.attack  = apvts.getRawParameterValue("filterAttack")->load();
-        filterParams.decay   = apvts.getRawParameterValue("filterDecayRelease")->load();
-        filterParams.sustain = apvts.getRawParameterValue("filterSustain")->load();
-        filterParams.release = apvts.getRawParameterValue("filterDecayRelease")->load(); // same knob
-
-        for (int i = 0; i < synth.getNumVoices(); ++i)
-        {
-            if (auto* voice = dynamic_cast<SineWaveVoice*>(synth.getVoice(i)))
-                voice->setFilterADSR(filterParams);
-        }
-    }
-}
-
-
 const juce::String _1xOscAudioProcessor::getName() const
 {
     return JucePlugin_Name;
@@ -249,44 +191,94 @@ void _1xOscAudioProcessor::changeProgramName (int index, const juce::String& new
 //==============================================================================
 void _1xOscAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    int waveform = static_cast<int>(*apvts.getRawParameterValue("waveform"));
+    // nothing may be rendering while the voices are rebuilt
+    renderAhead.stop();
+    updateBudgetMembership();
+    
     // Clear any existing voices
     synth.clearVoices();
 
-    // Add voices
-    for (int i = 0; i < 8; ++i)
+    // Add voices, fanned out across the stereo field (how far depends on the
+    // width knob): L, R, then gradually closer to the centre
+    const int numVoices = 8;
+    
+    for (int i = 0; i < numVoices; ++i)
     {
+        auto* voice = new SineWaveVoice();
+        const float distance = 1.0f - static_cast<float>(i / 2) / static_cast<float>(numVoices / 2);
+        voice->setSpreadPosition((i % 2 == 0) ? -distance : distance);
+        voice->setNoiseSeed(0x9e3779b9u * static_cast<juce::uint32>(i + 1));
+        synth.addVoice(voice);
+    }
+    
+    synth.prepare(samplesPerBlock, isUsingDoublePrecision());
+    governor.prepare(sampleRate);
+    outputLevel = *apvts.getRawParameterValue("level");
+    
+    // The render cache outlives the voices, so batch bounces keep reusing it
+    const bool useRenderCache = isRenderCacheEnabled() && ! isUsingDoublePrecision();
+    
+    if (useRenderCache)
+    {
+        renderCache.prepare(sampleRate, RenderCache::Options());
         
-        synth.addVoice(new SineWaveVoice());
+        if (getRenderCacheFile() != loadedRenderCacheFile)
+        {
+            loadedRenderCacheFile = getRenderCacheFile();
+            
+            if (loadedRenderCacheFile != juce::File())
+            {
+                const auto result = renderCache.load(loadedRenderCacheFile);
+                
+                if (result.failed())
+                    juce::Logger::writeToLog("Render cache: " + result.getErrorMessage());
+            }
+        }
     }
-
-    // Clear and set the sound
-    synth.clearSounds();
-    synth.addSound(new SineWaveSound());  // You can keep this for now or update it to match your voice
-    
-    // Set the waveform of the synth
-    SineWaveVoice::OscillatorMode selectedMode = SineWaveVoice::OscillatorMode::Sine;
-
-    if (waveform == 0)
-        selectedMode = SineWaveVoice::OscillatorMode::Sine;
-    else if (waveform == 1)
-        selectedMode = SineWaveVoice::OscillatorMode::Triangle;
-    else if (waveform == 2)
-        selectedMode = SineWaveVoice::OscillatorMode::Saw;
-    else if (waveform == 3)
-        selectedMode = SineWaveVoice::OscillatorMode::Square;
-    else if (waveform == 4)
-        selectedMode = SineWaveVoice::OscillatorMode::Noise;
-
-    // Loop through all voices and set the new mode
-    for (int i = 0; i < synth.getNumVoices(); ++i)
+    else
     {
+        renderCache.release();
+        loadedRenderCacheFile = juce::File();
+    }
+    
+    for (int i = 0; i < synth.getNumVoices(); ++i)
         if (auto* voice = dynamic_cast<SineWaveVoice*>(synth.getVoice(i)))
-            voice->setMode(selectedMode);
+            voice->setRenderCache(useRenderCache ? &renderCache : nullptr);
+    
+    synth.setTaskRunner(useRenderCache ? nullptr : voiceTaskRunner);
+    
+    // Pitch table for this rate, shared by every instance running at it. It's
+    // built in the background; the voices work their pitch out directly until
+    // then. Offline that would make the result depend on timing, so wait.
+    pitchTable = tableCache->getOrCreate<PitchTable>({ "pitch", {}, sampleRate },
+                                                     [sampleRate] (const std::function<bool()>&)
+                                                     {
+                                                         return std::make_unique<PitchTable>(sampleRate);
+                                                     });
+    
+    if (isNonRealtime())
+    {
+        pitchTable->waitUntilReady(1000);
+        wavetables.waitUntilReady(10000);
     }
 
+    // One sound, or one per part in multi-timbral mode
+    rebuildSounds();
+
     // Set the sample rate for the synth
     synth.setCurrentPlaybackSampleRate(sampleRate);
+    
+    // Push the current parameters into the fresh voices
+    updateVoiceParameters();
+    
+    // MIDI front end: quantise events onto the sub-block grid and make sure the
+    // synth never splits a block into smaller pieces than that
+    MidiEventCoalescer::Options midiOptions;
+    midiOptions.minimumSubBlockSize = getMidiSubBlockSize();
+    midiCoalescer.setOptions(midiOptions);
+    midiCoalescer.prepare(4096);
+    synth.setMinimumRenderingSubdivisionSize(midiOptions.minimumSubBlockSize, false);
+
     juce::Logger::writeToLog("Synth voice count: " + juce::String(synth.getNumVoices()));
     
     // Set up the filter
@@ -300,12 +292,46 @@ void _1xOscAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
         f.prepare(spec);
         f.reset();
     }
+    
+    // so adding a block's MIDI to what render-ahead left behind doesn't
+    // allocate on the audio thread
+    queuedMidi.ensureSize(4096);
+    
+    prepared = true;
+    startRenderAhead();
 }
 
 void _1xOscAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    renderAhead.stop();
+    prepared = false;
+    
+    // The cache itself stays, for the next prepareToPlay
+    if (renderCache.isPrepared() && loadedRenderCacheFile != juce::File())
+    {
+        const auto result = renderCache.save(loadedRenderCacheFile);
+        
+        if (result.failed())
+            juce::Logger::writeToLog("Render cache: " + result.getErrorMessage());
+    }
+}
+
+void _1xOscAudioProcessor::reset()
+{
+    // hosts call this from anywhere, sometimes while a block is being processed
+    const juce::ScopedLock sl (getCallbackLock());
+    
+    synth.allNotesOff(0, false);
+    
+    // the noise and supersaw phases start again from each voice's seed
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+        if (auto* voice = dynamic_cast<SineWaveVoice*>(synth.getVoice(i)))
+            voice->restartNoise();
+    
+    outputLevel = *apvts.getRawParameterValue("level");
+    governor.reset();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -322,6 +348,17 @@ bool _1xOscAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) c
     if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
      && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
         return false;
+    
+    // Part outputs can be off, mono or stereo
+    for (int bus = 1; bus < layouts.outputBuses.size(); ++bus)
+    {
+        const auto& set = layouts.outputBuses.getReference(bus);
+        
+        if (! set.isDisabled()
+         && set != juce::AudioChannelSet::mono()
+         && set != juce::AudioChannelSet::stereo())
+            return false;
+    }
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
@@ -336,81 +373,430 @@ bool _1xOscAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) c
 
 void _1xOscAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    // what render-ahead had been handed but not played when it was switched
+    // over goes first
+    if (! queuedMidi.isEmpty())
+    {
+        queuedMidi.addEvents(midiMessages, 0, -1, 0);
+        midiMessages.swapWith(queuedMidi);
+        queuedMidi.clear();
+    }
+    
+    // with render-ahead on, the synth runs on its own thread and this only
+    // hands the MIDI over and copies out what's ready
+    if (renderAhead.isActive())
+    {
+        renderAhead.process(buffer, midiMessages);
+        return;
+    }
+    
+    processSamples(buffer, midiMessages);
+}
+
+void _1xOscAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(buffer, midiMessages);
+}
+
+template <typename SampleType>
+void _1xOscAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages)
+{
+    ONEXOSC_AUDIO_THREAD_SCOPE("processBlock");
+    ONEXOSC_TRACE_SCOPE("processBlock");
+    const auto startTicks = juce::Time::getHighResolutionTicks();
     juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
-
-    // In case we have more outputs than inputs, this code clears any output
-    // channels that didn't contain input data, (because these aren't
-    // guaranteed to be empty - they may contain garbage).
-    // This is here to avoid people getting screaming feedback
-    // when they first compile a plugin, but obviously you don't need to keep
-    // this code if your algorithm always overwrites all the output channels.
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
-
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
-    {
-        auto* channelData = buffer.getWritePointer (channel);
-
-        // ..do something to the data...
-    }
-    
-    // Update the special knob
-    float special = apvts.getRawParameterValue("special")->load();
-    // update the special value in the voices
+
+    // The voices add themselves into the outputs, so those have to start
+    // from silence. The input buses share their channels with the first
+    // outputs (main and part 2), so what the host put there is input audio,
+    // which a synth has no use for: the whole buffer is cleared.
+    buffer.clear();
+    
+    {
+        ONEXOSC_TRACE_SCOPE("midi");
+        midiCoalescer.process(midiMessages, buffer.getNumSamples());
+    }
+    
+    // Push the current knob values to the voices once, before rendering, so
+    // voices started by this block's MIDI pick them up too
+    {
+        ONEXOSC_AUDIO_THREAD_SCOPE("updateVoiceParameters");
+        ONEXOSC_TRACE_SCOPE("updateVoiceParameters");
+        updateVoiceParameters();
+    }
+    
+    updatePartOutputs(buffer);
+    
+    auto mainOutput = getBusBuffer(buffer, false, 0);
+    
+    {
+        ONEXOSC_TRACE_SCOPE("synth");
+        synth.renderNextBlock(mainOutput, midiMessages, 0, buffer.getNumSamples());
+    }
+    
+    // Apply the level (in multi-timbral mode each part's level is applied by its voices)
+    if (! isMultiTimbral())
+    {
+        // unity is skipped; a change is ramped over the block instead of stepped
+        ONEXOSC_TRACE_SCOPE("gain");
+        const float level = *apvts.getRawParameterValue("level");
+        const float previousLevel = std::exchange(outputLevel, level);
+        
+        if (level != previousLevel)
+            buffer.applyGainRamp(0, buffer.getNumSamples(), static_cast<SampleType>(previousLevel), static_cast<SampleType>(level));
+        else if (level != 1.0f)
+            buffer.applyGain(static_cast<SampleType>(level));
+    }
+    else
+    {
+        outputLevel = 1.0f;
+    }
+    
+    // Lets the wavetable loader free tables this block might have been using
+    wavetables.audioBlockFinished();
+    
+    const auto secondsTaken = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    
+    // How close this block came to its deadline decides the next one's quality
+    if (isAdaptiveQuality() && ! isNonRealtime())
+    {
+        governor.blockFinished(secondsTaken, buffer.getNumSamples());
+    }
+    else if (governor.getLevelIndex() != 0)
+    {
+        // starts again from full quality next time it's switched on
+        governor.reset();
+    }
+    
+    // and the other instances' numbers decide what this one has to give up
+    if (isSharedBudget() && ! isNonRealtime())
+    {
+        applySharedBudget(secondsTaken, buffer.getNumSamples());
+    }
+    else if (reportingToBudget)
+    {
+        budget.stop();
+        reportingToBudget = false;
+    }
+}
+
+void _1xOscAudioProcessor::applySharedBudget (double secondsTaken, int numSamples)
+{
+    if (getSampleRate() <= 0.0 || numSamples <= 0)
+        return;
+    
+    const double blockSeconds = numSamples / getSampleRate();
+    
+    // voices already on their way out don't count, or they'd be stolen twice
+    SharedBudget::Report report;
+    report.load = static_cast<float>(secondsTaken / blockSeconds);
+    
     for (int i = 0; i < synth.getNumVoices(); ++i)
     {
         if (auto* voice = dynamic_cast<SineWaveVoice*>(synth.getVoice(i)))
         {
-            if (voice->isVoiceActive())
+            if (voice->isVoiceActive() && ! voice->isFadingOut())
             {
-                voice->setSpecial(special);
+                ++report.numVoices;
+                report.loudness += voice->getCurrentLevel();
             }
         }
     }
     
-    synth.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
+    reportingToBudget = true;
     
-    // Apply filter DSP
-    auto* cutoffParam = apvts.getRawParameterValue("filterCutoff");
-    auto* resonanceParam = apvts.getRawParameterValue("filterResonance");
-    auto* typeParam = apvts.getRawParameterValue("filterType");
+    // the quietest voices go first
+    for (int toSteal = budget.blockFinished(report, blockSeconds); toSteal > 0; --toSteal)
+    {
+        SineWaveVoice* quietest = nullptr;
+        
+        for (int i = 0; i < synth.getNumVoices(); ++i)
+        {
+            auto* voice = dynamic_cast<SineWaveVoice*>(synth.getVoice(i));
+            
+            if (voice != nullptr && voice->isVoiceActive() && ! voice->isFadingOut()
+                && (quietest == nullptr || voice->getCurrentLevel() < quietest->getCurrentLevel()))
+                quietest = voice;
+        }
+        
+        if (quietest == nullptr)
+            break;
+        
+        quietest->fadeOut();
+    }
+}
+
+void _1xOscAudioProcessor::updateVoiceParameters()
+{
+    PatchSnapshot current;
+    patchSource.read(current);
     
-    float filterAmount = apvts.getRawParameterValue("filterAmount")->load() / 100.0f; // -1.0 to 1.0
+    const auto accuracy = isNonRealtime() ? offlineMathAccuracy.load() : liveMathAccuracy.load();
+    const auto* wavetable = wavetables.getTable();
+    const auto* pitches = pitchTable != nullptr ? pitchTable->get<PitchTable>() : nullptr;
+    const auto& quality = QualityGovernor::getLevel(isNonRealtime() ? 0 : getQualityLevel());
     
+    // A patch or quality change, a note off or a steal hands replaying notes
+    // over to live rendering. In real time that's spread out, about one
+    // note's worth per block; offline it all happens at once, as a render
+    // without the cache would have it.
+    renderCache.setHandOverBudget(isNonRealtime() ? std::numeric_limits<int>::max() : RenderCache::chunkSize);
     
-    float baseCutoff = std::clamp(cutoffParam->load(), 20.0f, 20000.0f);
-    float resonance = std::clamp(resonanceParam->load(), 0.1f, 10.0f);
-    int typeValue = static_cast<int>(typeParam->load());
-
-    juce::dsp::StateVariableFilter::Parameters<float>::Type filterType =
-        juce::dsp::StateVariableFilter::Parameters<float>::Type::lowPass;
-    if (typeValue == 1) filterType = juce::dsp::StateVariableFilter::Parameters<float>::Type::bandPass;
-    else if (typeValue == 2) filterType = juce::dsp::StateVariableFilter::Parameters<float>::Type::highPass;
-
-    // pass all that to each active voice
+    // These go to every voice every block, whatever happens with the patch
+    // below: a voice left holding last block's wavetable would read freed
+    // memory once the loader retires it.
     for (int i = 0; i < synth.getNumVoices(); ++i)
     {
         if (auto* voice = dynamic_cast<SineWaveVoice*>(synth.getVoice(i)))
         {
-            if (voice->isVoiceActive())
-            {
-                voice->setFilterParams(baseCutoff, resonance, filterType, filterAmount);
-            }
+            voice->setMathAccuracy(accuracy);
+            voice->setWavetable(wavetable);
+            voice->setPitchTable(pitches);
+            voice->setQuality(quality);
+        }
+    }
+    
+    if (! isMultiTimbral())
+    {
+        for (int i = 0; i < synth.getNumVoices(); ++i)
+            if (auto* voice = dynamic_cast<SineWaveVoice*>(synth.getVoice(i)))
+                voice->applyPatch(current, false);
+        
+        return;
+    }
+    
+    // The message thread holds the lock while it swaps the edited part; in that
+    // (rare) case the voices just keep last block's patch.
+    const juce::SpinLock::ScopedTryLockType lock (partLock);
+    
+    if (! lock.isLocked())
+        return;
+    
+    // unless setEditPart is still loading a part onto the knobs
+    if (! loadingPart.load())
+        parts[(size_t) getEditPart()] = current;
+    
+    for (int i = 0; i < synth.getNumVoices(); ++i)
+        if (auto* voice = dynamic_cast<SineWaveVoice*>(synth.getVoice(i)))
+            voice->applyPatch(parts[(size_t) juce::jlimit(0, OscSynthesiser::maxParts - 1, voice->getPartIndex())], true);
+}
+
+void _1xOscAudioProcessor::setMathAccuracy (FastMath::Accuracy live, FastMath::Accuracy offline)
+{
+    liveMathAccuracy = live;
+    offlineMathAccuracy = offline;
+}
+
+juce::Result _1xOscAudioProcessor::loadWavetable (const juce::File& file)
+{
+    auto result = wavetables.loadFile(file);
+    
+    if (result.wasOk())
+        apvts.state.setProperty("wavetableFile", file.getFullPathName(), nullptr);
+    
+    return result;
+}
+
+template <typename SampleType>
+void _1xOscAudioProcessor::updatePartOutputs (juce::AudioBuffer<SampleType>& buffer)
+{
+    if (! isMultiTimbral())
+    {
+        synth.clearPartOutputs();
+        return;
+    }
+    
+    auto& outputs = [this]() -> PartBuffers<SampleType>&
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doublePartBuffers;
+        else
+            return partBuffers;
+    }();
+    
+    // Part 1 renders into the main output, so its entry stays empty
+    outputs.pointers.fill(nullptr);
+    
+    for (int part = 1; part < juce::jmin(getBusCount(false), OscSynthesiser::maxParts); ++part)
+    {
+        auto* bus = getBus(false, part);
+        
+        if (bus != nullptr && bus->isEnabled() && bus->getNumberOfChannels() > 0)
+        {
+            outputs.buffers[(size_t) part] = bus->getBusBuffer(buffer);
+            outputs.pointers[(size_t) part] = &outputs.buffers[(size_t) part];
         }
     }
     
-    // Apply the level
-    float level = *apvts.getRawParameterValue("level");
-    buffer.applyGain(level);
+    synth.setPartOutputs(outputs.pointers.data(), OscSynthesiser::maxParts);
+}
 
+void _1xOscAudioProcessor::rebuildSounds()
+{
+    synth.allNotesOff(0, false);
+    synth.clearSounds();
+    
+    if (isMultiTimbral())
+    {
+        for (int part = 0; part < OscSynthesiser::maxParts; ++part)
+            synth.addSound(new SineWaveSound(part, part + 1));
+    }
+    else
+    {
+        synth.addSound(new SineWaveSound());
+    }
+}
+
+void _1xOscAudioProcessor::setMultiTimbral (bool shouldBeMultiTimbral)
+{
+    if (shouldBeMultiTimbral == isMultiTimbral())
+        return;
+    
+    {
+        const juce::SpinLock::ScopedLockType lock (partLock);
+        
+        // The first time round every part starts out as a copy of the current sound
+        if (shouldBeMultiTimbral && ! apvts.state.getProperty("partsInitialised", false))
+        {
+            PatchSnapshot current;
+            patchSource.read(current);
+            parts.fill(current);
+            apvts.state.setProperty("partsInitialised", true, nullptr);
+        }
+        
+        multiTimbral = shouldBeMultiTimbral;
+        apvts.state.setProperty("multiTimbral", shouldBeMultiTimbral, nullptr);
+    }
+    
+    rebuildSounds();
+}
+
+void _1xOscAudioProcessor::setEditPart (int partIndex)
+{
+    partIndex = juce::jlimit(0, OscSynthesiser::maxParts - 1, partIndex);
+    
+    if (partIndex == getEditPart())
+        return;
+    
+    PatchSnapshot patch;
+    
+    {
+        const juce::SpinLock::ScopedLockType lock (partLock);
+        
+        // Keep what the knobs currently show, then load the new part onto them.
+        // Until they show it, the audio thread mustn't copy them into the part.
+        patchSource.read(parts[(size_t) getEditPart()]);
+        editPart = partIndex;
+        loadingPart = true;
+        patch = parts[(size_t) partIndex];
+    }
+    
+    apvts.state.setProperty("editPart", partIndex, nullptr);
+    
+    // The host hears about it outside the lock, which the audio thread takes
+    const auto& ids = PatchSnapshot::getParameterIDs();
+    
+    for (int i = 0; i < ids.size(); ++i)
+    {
+        if (auto* param = apvts.getParameter(ids[i]))
+            param->setValueNotifyingHost(param->convertTo0to1(patch.getValue(i)));
+    }
+    
+    loadingPart = false;
+}
+
+void _1xOscAudioProcessor::setAdaptiveQuality (bool shouldAdapt)
+{
+    adaptiveQuality = shouldAdapt;
+    apvts.state.setProperty("adaptiveQuality", shouldAdapt, nullptr);
+}
+
+void _1xOscAudioProcessor::setSharedBudget (bool shouldShare)
+{
+    sharedBudget = shouldShare;
+    apvts.state.setProperty("sharedBudget", shouldShare, nullptr);
+    updateBudgetMembership();
+}
+
+void _1xOscAudioProcessor::updateBudgetMembership()
+{
+    // only instances that share hold a slot in the table
+    if (isSharedBudget())
+    {
+        budget.join();
+        return;
+    }
+    
+    // the audio thread may be publishing into it
+    const juce::ScopedLock sl (getCallbackLock());
+    budget.leave();
+    reportingToBudget = false;
+}
+
+void _1xOscAudioProcessor::setRenderAhead (int numBlocks)
+{
+    apvts.state.setProperty("renderAheadBlocks", juce::jlimit(0, 16, numBlocks), nullptr);
+    
+    // Already playing: swap over between two device callbacks
+    if (prepared)
+    {
+        const juce::ScopedLock sl (getCallbackLock());
+        startRenderAhead();
+    }
+}
+
+int _1xOscAudioProcessor::getRenderAhead() const
+{
+    return juce::jlimit(0, 16, static_cast<int>(apvts.state.getProperty("renderAheadBlocks", 0)));
+}
+
+bool _1xOscAudioProcessor::canRenderAhead() const
+{
+    // In a plugin the host owns the threads and the timing, and the latency
+    // would have to be compensated for
+    return wrapperType == wrapperType_Standalone && ! isUsingDoublePrecision();
+}
+
+void _1xOscAudioProcessor::startRenderAhead()
+{
+    renderAhead.stop();
+    renderAhead.takeQueuedEvents(queuedMidi);
+    
+    if (canRenderAhead() && getRenderAhead() > 0 && ! isNonRealtime())
+    {
+        renderAhead.start(getSampleRate(), getBlockSize(),
+                          juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()),
+                          getRenderAhead());
+    }
+    
+    setLatencySamples(renderAhead.isActive() ? renderAhead.getLatencySamples() : 0);
+}
+
+void _1xOscAudioProcessor::setRenderCache (bool shouldCache, const juce::File& file)
+{
+    apvts.state.setProperty("renderCache", shouldCache, nullptr);
+    apvts.state.setProperty("renderCacheFile", file.getFullPathName(), nullptr);
+}
+
+bool _1xOscAudioProcessor::isRenderCacheEnabled() const
+{
+    return static_cast<bool>(apvts.state.getProperty("renderCache", false));
+}
+
+juce::File _1xOscAudioProcessor::getRenderCacheFile() const
+{
+    const auto path = apvts.state.getProperty("renderCacheFile").toString();
+    return path.isNotEmpty() ? juce::File(path) : juce::File();
+}
+
+void _1xOscAudioProcessor::setMidiSubBlockSize (int numSamples)
+{
+    apvts.state.setProperty("midiSubBlockSize", juce::jlimit(1, 512, numSamples), nullptr);
+}
+
+int _1xOscAudioProcessor::getMidiSubBlockSize() const
+{
+    return juce::jlimit(1, 512, static_cast<int>(apvts.state.getProperty("midiSubBlockSize", 1)));
 }
 
 //==============================================================================
@@ -433,6 +819,18 @@ void _1xOscAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     
     // Save the state of the APVTS
     auto state = apvts.copyState();
+    
+    // ...plus the snapshot of every part
+    {
+        const juce::SpinLock::ScopedLockType lock (partLock);
+        juce::ValueTree partsTree ("PARTS");
+        
+        for (int part = 0; part < OscSynthesiser::maxParts; ++part)
+            partsTree.appendChild(parts[(size_t) part].toValueTree(part), nullptr);
+        
+        state.appendChild(partsTree, nullptr);
+    }
+    
     std::unique_ptr<juce::XmlElement> xml (state.createXml());
     copyXmlToBinary(*xml, destData);
 }
@@ -445,9 +843,60 @@ void _1xOscAudioProcessor::setStateInformation (const void* data, int sizeInByte
     // Restore the state of the APVTS
         std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary(data, sizeInBytes));
         
-        if (xmlState != nullptr)
-            if (xmlState->hasTagName(apvts.state.getType()))
-                apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+        if (xmlState == nullptr || ! xmlState->hasTagName(apvts.state.getType()))
+            return;
+    
+        apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
+    
+    {
+        const juce::SpinLock::ScopedLockType lock (partLock);
+        auto partsTree = apvts.state.getChildWithName("PARTS");
+        multiTimbral = static_cast<bool>(apvts.state.getProperty("multiTimbral", false));
+        
+        if (partsTree.isValid())
+        {
+            for (auto partTree : partsTree)
+            {
+                int part = partTree.getProperty("index", -1);
+                
+                if (juce::isPositiveAndBelow(part, OscSynthesiser::maxParts))
+                    parts[(size_t) part].fromValueTree(partTree);
+            }
+            
+            // the parts live in `parts` from here on, they're written back on save
+            apvts.state.removeChild(partsTree, nullptr);
+        }
+        else
+        {
+            // A session from before the parts: none of the previous session's
+            // parts belong to it, so they all start out as its sound, the way
+            // setMultiTimbral() fills them the first time
+            PatchSnapshot loaded;
+            patchSource.read(loaded);
+            parts.fill(loaded);
+            
+            if (multiTimbral)
+                apvts.state.setProperty("partsInitialised", true, nullptr);
+            else
+                apvts.state.removeProperty("partsInitialised", nullptr);
+        }
+        
+        editPart = juce::jlimit(0, OscSynthesiser::maxParts - 1, static_cast<int>(apvts.state.getProperty("editPart", 0)));
+    }
+    
+    adaptiveQuality = static_cast<bool>(apvts.state.getProperty("adaptiveQuality", false));
+    sharedBudget = static_cast<bool>(apvts.state.getProperty("sharedBudget", false));
+    updateBudgetMembership();
+    
+    rebuildSounds();
+    
+    // Reload the wavetable the session was using (in the background)
+    const auto wavetablePath = apvts.state.getProperty("wavetableFile").toString();
+    
+    if (wavetablePath.isEmpty())
+        wavetables.unload();
+    else if (juce::File(wavetablePath) != wavetables.getFile())
+        wavetables.loadFile(juce::File(wavetablePath));
 }
 
 void _1xOscAudioProcessor::parameterValueChanged(int parameterIndex, float newValue){
@@ -460,7 +909,9 @@ void _1xOscAudioProcessor::parameterGestureChanged(int parameterIndex, bool gest
 
 //==============================================================================
 // This creates new instances of the plugin..
+#if ! ONEXOSC_CLAP
 juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 {
     return new _1xOscAudioProcessor();
 }
+#endif
@@ -10,15 +10,31 @@
 
 #include <JuceHeader.h>
 #include <juce_dsp/juce_dsp.h>
+#include "MidiEventCoalescer.h"
+#include "OscSynthesiser.h"
+#include "PatchSnapshot.h"
+#include "FastMath.h"
+#include "WavetableLoader.h"
+#include "SharedTableCache.h"
+#include "QualityGovernor.h"
+#include "RenderCache.h"
+#include "SharedBudget.h"
+#include "RenderAhead.h"
 #define JucePlugin_WantsMidiInput 1
 #define JucePlugin_ProducesMidiOutput 0
 #define JucePlugin_IsSynth 1  // Important! This tells JUCE the plugin is a synth
 
+// Set by clap/CMakeLists.txt. That build creates its processor in
+// ClapProcessor.cpp instead of the one in PluginProcessor.cpp.
+#ifndef ONEXOSC_CLAP
+ #define ONEXOSC_CLAP 0
+#endif
+
 //==============================================================================
 /**
 */
 
-class _1xOscAudioProcessor  : public juce::AudioProcessor, public juce::AudioProcessorValueTreeState::Listener
+class _1xOscAudioProcessor  : public juce::AudioProcessor
 {
 public:
     //==============================================================================
@@ -28,12 +44,22 @@ public:
     //==============================================================================
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    
+    // Stops every voice dead and puts them back the way prepareToPlay left
+    // them, so the next block renders exactly as the first one after it would
+    // (with the knobs as they are now). Doesn't allocate, but re-seeds every
+    // voice, so it isn't free either.
+    void reset() override;
 
    #ifndef JucePlugin_PreferredChannelConfigurations
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    
+    // The whole signal path runs in the host's precision
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -60,12 +86,84 @@ public:
     
     juce::AudioProcessorValueTreeState apvts;
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
-    void parameterChanged(const juce::String& parameterID, float newValue) override; // <-- Declare this method
 
     
     void parameterValueChanged(int parameterIndex, float newValue);
     void parameterGestureChanged(int parameterIndex, bool gestureIsStarting);
-    juce::Synthesiser synth;
+    OscSynthesiser synth;
+    
+    // Minimum number of samples the synth renders between MIDI events: events
+    // are moved onto a grid this coarse. 1 (the default) keeps every event on
+    // its own sample; coarser grids are opt-in, for dense MIDI streams.
+    // Stored in the state so it's recalled with the session; applied in prepareToPlay.
+    void setMidiSubBlockSize (int numSamples);
+    int getMidiSubBlockSize() const;
+    
+    // Multi-timbral mode: one part per MIDI channel, all sharing the voice pool.
+    // The knobs edit the part chosen with setEditPart, the other parts keep
+    // their own snapshot. Parts 2-16 can go to their own output buses.
+    void setMultiTimbral (bool shouldBeMultiTimbral);
+    bool isMultiTimbral() const { return multiTimbral.load(); }
+    void setEditPart (int partIndex);
+    int getEditPart() const { return editPart.load(); }
+    
+    // Accuracy of the oscillator / filter maths (see FastMath.h): draft while
+    // playing live, exact when the host renders offline, unless changed here.
+    void setMathAccuracy (FastMath::Accuracy live, FastMath::Accuracy offline);
+    
+    // User wavetable played while the Wavetable parameter is on (special = frame
+    // position). The file is remembered in the state and reloaded with it.
+    juce::Result loadWavetable (const juce::File& file);
+    juce::File getWavetableFile() const { return wavetables.getFile(); }
+    
+    // Adaptive quality: when processBlock gets close to its deadline the
+    // governor lowers the quality in steps (see QualityGovernor.h) and raises
+    // it again once there's headroom. Off by default; remembered in the state.
+    // Never applies to offline renders.
+    void setAdaptiveQuality (bool shouldAdapt);
+    bool isAdaptiveQuality() const { return adaptiveQuality.load(); }
+    int getQualityLevel() const
+    {
+        return juce::jmax(isAdaptiveQuality() ? governor.getLevelIndex() : 0,
+                          isSharedBudget() ? budget.getLevelIndex() : 0);
+    }
+    float getDspLoad() const { return governor.getLoad(); }
+    
+    // Shared budget (see SharedBudget.h): the instances that have it on share
+    // one voice and CPU budget for the whole process (setBudget on
+    // getSharedBudget()), and when they go over it the quietest give up
+    // voices and quality first. Off by default; remembered in the state.
+    // Never applies to offline renders.
+    void setSharedBudget (bool shouldShare);
+    bool isSharedBudget() const { return sharedBudget.load(); }
+    SharedBudget& getSharedBudget() { return budget.getShared(); }
+    
+    // Render cache (see RenderCache.h): the attack and decay of notes whose
+    // patch has nothing random in it are kept the first time they play and
+    // replayed after that. Off by default. With a file, the cache is loaded
+    // from it in prepareToPlay and saved back in releaseResources. Both are
+    // remembered in the state; applied in prepareToPlay. Float hosts only.
+    void setRenderCache (bool shouldCache, const juce::File& file = {});
+    bool isRenderCacheEnabled() const;
+    juce::File getRenderCacheFile() const;
+    const RenderCache& getRenderCache() const { return renderCache; }
+    
+    // Renders the voices of a busy block in parallel on someone else's
+    // threads (see OscSynthesiser::TaskRunner); the CLAP build passes the
+    // host's thread pool. Applied in prepareToPlay. Voices render serially
+    // without one, and while the render cache is on (they'd all share it).
+    void setVoiceTaskRunner (OscSynthesiser::TaskRunner* runner) { voiceTaskRunner = runner; }
+    
+    // Render-ahead (see RenderAhead.h), Standalone app only: the synth renders
+    // on its own thread numBlocks blocks ahead of the audio device, which only
+    // copies out of a ring. More blocks = more latency, fewer dropouts; 0 is
+    // off. Remembered in the state; applied in prepareToPlay, and straight
+    // away while playing. Float only.
+    void setRenderAhead (int numBlocks);
+    int getRenderAhead() const;
+    bool canRenderAhead() const;
+    int getRenderAheadUnderruns() const { return renderAhead.getNumUnderruns(); }
+    int getRenderAheadDroppedEvents() const { return renderAhead.getNumDroppedEvents(); }
     
     std::array<
         juce::dsp::ProcessorDuplicator<
@@ -77,6 +175,70 @@ public:
     
     
 private:
+    static BusesProperties createBusesProperties();
+    
+    void updateVoiceParameters();
+    template <typename SampleType>
+    void processSamples (juce::AudioBuffer<SampleType>& buffer, juce::MidiBuffer& midiMessages);
+    
+    template <typename SampleType>
+    void updatePartOutputs (juce::AudioBuffer<SampleType>& buffer);
+    void rebuildSounds();
+    void applySharedBudget (double secondsTaken, int numSamples);
+    void updateBudgetMembership();
+    void startRenderAhead();
+
+    MidiEventCoalescer midiCoalescer;
+    
+    PatchSnapshot::Source patchSource;
+    std::array<PatchSnapshot, OscSynthesiser::maxParts> parts;
+    
+    // The part buses' slices of the host buffer, in the precision it's using
+    template <typename SampleType>
+    struct PartBuffers
+    {
+        std::array<juce::AudioBuffer<SampleType>, OscSynthesiser::maxParts> buffers;
+        std::array<juce::AudioBuffer<SampleType>*, OscSynthesiser::maxParts> pointers {};
+    };
+    
+    PartBuffers<float> partBuffers;
+    PartBuffers<double> doublePartBuffers;
+    
+    juce::SpinLock partLock;
+    std::atomic<bool> multiTimbral { false };
+    std::atomic<int> editPart { 0 };
+    std::atomic<bool> loadingPart { false };   // setEditPart is moving a part onto the knobs
+    
+    std::atomic<FastMath::Accuracy> liveMathAccuracy { FastMath::Accuracy::draft };
+    std::atomic<FastMath::Accuracy> offlineMathAccuracy { FastMath::Accuracy::exact };
+    
+    WavetableLoader wavetables;
+    
+    float outputLevel = 1.0f;   // the level the last block ended on
+    
+    QualityGovernor governor;
+    std::atomic<bool> adaptiveQuality { false };
+    
+    SharedBudget::Member budget;
+    std::atomic<bool> sharedBudget { false };
+    bool reportingToBudget = false;
+    
+    RenderCache renderCache { sizeof (SineWaveVoice::RenderState), SineWaveVoice::getRenderStateLayout() };
+    juce::File loadedRenderCacheFile;
+    
+    OscSynthesiser::TaskRunner* voiceTaskRunner = nullptr;
+    
+    bool prepared = false;   // between prepareToPlay and releaseResources
+    RenderAhead renderAhead { [this] (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+                              {
+                                  processSamples(buffer, midiMessages);
+                              } };
+    juce::MidiBuffer queuedMidi;   // see startRenderAhead
+    
+    // Tables shared with the other instances in the process
+    juce::SharedResourcePointer<SharedTableCache> tableCache;
+    SharedTableCache::EntryPtr pitchTable;
+    
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (_1xOscAudioProcessor)
 };
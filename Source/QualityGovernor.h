@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    QualityGovernor.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+// Trades fidelity for headroom when processBlock gets close to its deadline.
+//
+// The processor reports how long every block took; the governor keeps a
+// smoothed load (time taken / time the block lasts) and steps the quality
+// down one level when the load stays above degradeAbove for degradeAfter
+// seconds, or straight away when a block overruns. It only steps back up once
+// the load has stayed below restoreBelow for restoreAfter seconds, so it
+// doesn't flap around a threshold.
+//
+// Each level only ever makes the previous one cheaper:
+//  1. the filter cutoff follows its envelope at control rate,
+//  2. fewer additive harmonics and fewer supersaw unison voices,
+//  3. fewer still, and quiet release tails (below -50 dB) are cut,
+//  4. the bare minimum, tails cut below -40 dB.
+//
+// Offline renders always run at level 0. Everything here is lock-free; the
+// level can be read from any thread.
+class QualityGovernor
+{
+public:
+    struct Level
+    {
+        int maxHarmonics;           // additive harmonics in Sine mode
+        int numUnisonVoices;        // supersaw voices, from the centre out
+        int filterUpdateInterval;   // samples between cutoff updates while the envelope moves
+        float releaseStealLevel;    // released voices quieter than this are stopped (0 = never)
+    };
+
+    static constexpr int numLevels = 5;
+
+    static const Level& getLevel (int index) noexcept
+    {
+        static constexpr Level levels[numLevels] =
+        {
+            { 256, 7, 1,  0.0f },
+            { 256, 7, 16, 0.0f },
+            { 16,  5, 16, 0.0f },
+            { 8,   3, 32, 0.003f },
+            { 3,   1, 64, 0.01f }
+        };
+
+        return levels[std::clamp (index, 0, numLevels - 1)];
+    }
+
+    struct Options
+    {
+        float degradeAbove = 0.8f;      // smoothed load that starts the degrade timer
+        float restoreBelow = 0.5f;      // smoothed load that starts the restore timer
+        double degradeAfter = 0.05;     // seconds of audio
+        double restoreAfter = 2.0;      // seconds of audio
+        double smoothingTime = 0.05;    // seconds of audio
+    };
+
+    void setOptions (const Options& newOptions) noexcept    { options = newOptions; }
+
+    void prepare (double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        load = 0.0f;
+        timeOverLimit = timeUnderLimit = 0.0;
+        level = 0;
+    }
+
+    // Audio thread, after every block
+    void blockFinished (double secondsTaken, int numSamples) noexcept
+    {
+        if (numSamples <= 0 || sampleRate <= 0.0)
+            return;
+
+        const auto blockSeconds = numSamples / sampleRate;
+        const auto blockLoad = static_cast<float> (secondsTaken / blockSeconds);
+        const auto alpha = static_cast<float> (1.0 - std::exp (-blockSeconds / options.smoothingTime));
+        const auto current = load.load (std::memory_order_relaxed);
+        const auto smoothed = current + alpha * (blockLoad - current);
+        load.store (smoothed, std::memory_order_relaxed);
+
+        const auto currentLevel = level.load (std::memory_order_relaxed);
+        timeOverLimit = smoothed > options.degradeAbove ? timeOverLimit + blockSeconds : 0.0;
+        timeUnderLimit = smoothed < options.restoreBelow ? timeUnderLimit + blockSeconds : 0.0;
+
+        if ((blockLoad >= 1.0f || timeOverLimit >= options.degradeAfter) && currentLevel < numLevels - 1)
+            changeLevel (currentLevel + 1);
+        else if (timeUnderLimit >= options.restoreAfter && currentLevel > 0)
+            changeLevel (currentLevel - 1);
+    }
+
+    int getLevelIndex() const noexcept    { return level.load (std::memory_order_relaxed); }
+    float getLoad() const noexcept        { return load.load (std::memory_order_relaxed); }
+
+private:
+    void changeLevel (int newLevel) noexcept
+    {
+        level.store (newLevel, std::memory_order_relaxed);
+
+        // the next decision is made on blocks rendered at the new level
+        timeOverLimit = timeUnderLimit = 0.0;
+    }
+
+    Options options;
+    double sampleRate = 0.0;
+
+    std::atomic<float> load { 0.0f };
+    std::atomic<int> level { 0 };
+    double timeOverLimit = 0.0;
+    double timeUnderLimit = 0.0;
+};
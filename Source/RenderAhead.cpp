@@ -0,0 +1,304 @@
+/*
+  ==============================================================================
+
+    RenderAhead.cpp
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "RenderAhead.h"
+
+RenderAhead::RenderAhead (RenderFunction functionToRender)
+    : juce::Thread ("1xOsc render-ahead"),
+      render (std::move (functionToRender)),
+      events ((size_t) minQueuedEvents)
+{
+}
+
+namespace
+{
+    bool isNoteOff (const juce::uint8* data, int size) noexcept
+    {
+        const auto type = data[0] & 0xf0;
+        return size == 3 && (type == 0x80 || (type == 0x90 && data[2] == 0));
+    }
+
+    bool isNoteOn (const juce::uint8* data, int size) noexcept
+    {
+        return size == 3 && (data[0] & 0xf0) == 0x90 && data[2] != 0;
+    }
+
+    // What can go missing without leaving anything stuck: a newer value
+    // follows soon enough. Not the sustain pedal or the channel mode messages
+    // (all notes off and the like).
+    bool isContinuous (const juce::uint8* data, int size) noexcept
+    {
+        switch (data[0] & 0xf0)
+        {
+            case 0xa0: case 0xd0: case 0xe0:   return true;
+            case 0xb0:                         return size == 3 && data[1] != 64 && data[1] < 120;
+            default:                           return false;
+        }
+    }
+}
+
+RenderAhead::~RenderAhead()
+{
+    stop();
+}
+
+void RenderAhead::start (double newSampleRate, int newBlockSize, int numChannels, int blocksAhead)
+{
+    stop();
+
+    sampleRate = newSampleRate;
+    blockSize = juce::jmax (1, newBlockSize);
+    latencySamples = blockSize * juce::jmax (1, blocksAhead);
+
+    // The ring holds latencySamples at most, so the render thread is never
+    // further ahead than the MIDI it's waiting for
+    audioFifo = std::make_unique<juce::AbstractFifo> (latencySamples + 1);
+    ring.setSize (juce::jmax (1, numChannels), latencySamples + 1);
+    renderBuffer.setSize (juce::jmax (1, numChannels), blockSize);
+
+    // room for an event on every sample of the delay and the block on its way in
+    const auto queueSize = juce::jmax (minQueuedEvents, latencySamples + blockSize);
+    eventFifo.setTotalSize (queueSize);
+    events.resize ((size_t) queueSize);
+    renderMidi.ensureSize ((size_t) queueSize * 16);
+
+    eventFifo.reset();
+    samplesToDrop = 0;
+    numUnderruns = 0;
+    numDroppedEvents = 0;
+    pendingNoteOffs.reset();
+    numPendingNoteOffs = 0;
+
+    // It starts full of silence, so the first callbacks have something to play
+    ring.clear();
+    audioFifo->finishedWrite (latencySamples);
+    devicePosition = 0;
+    renderPosition = latencySamples;
+
+    active.store (true, std::memory_order_release);
+
+    // Woken about twice per block. The callback never signals it: that would
+    // take a lock on the device thread.
+    if (! startRealtimeThread (juce::Thread::RealtimeOptions().withPeriodMs (1000.0 * blockSize / sampleRate)))
+        startThread (juce::Thread::Priority::highest);
+}
+
+void RenderAhead::stop()
+{
+    active.store (false, std::memory_order_release);
+    stopThread (2000);
+}
+
+void RenderAhead::takeQueuedEvents (juce::MidiBuffer& dest)
+{
+    jassert (! isThreadRunning());
+
+    {
+        const auto scope = eventFifo.read (eventFifo.getNumReady());
+
+        for (int i = 0; i < scope.blockSize1 + scope.blockSize2; ++i)
+        {
+            const auto& event = events[(size_t) (i < scope.blockSize1 ? scope.startIndex1 + i : scope.startIndex2 + i - scope.blockSize1)];
+            dest.addEvent (event.data, event.size, 0);
+        }
+    }
+
+    for (int i = 0; i < (int) pendingNoteOffs.size() && numPendingNoteOffs > 0; ++i)
+    {
+        if (pendingNoteOffs[(size_t) i])
+        {
+            dest.addEvent (juce::MidiMessage::noteOff (i / 128 + 1, i % 128), 0);
+            --numPendingNoteOffs;
+        }
+    }
+
+    pendingNoteOffs.reset();
+    numPendingNoteOffs = 0;
+}
+
+//==============================================================================
+void RenderAhead::process (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+
+    // Note offs left over from a full queue go first
+    if (numPendingNoteOffs > 0)
+        queuePendingNoteOffs (devicePosition + latencySamples);
+
+    // This block's MIDI plays latencySamples from now
+    for (const auto metadata : midiMessages)
+    {
+        if (metadata.numBytes > 3)
+            continue;
+
+        const auto time = devicePosition + metadata.samplePosition + latencySamples;
+        const auto* data = metadata.data;
+        const auto size = metadata.numBytes;
+
+        if (isNoteOff (data, size))
+        {
+            const auto key = (size_t) ((data[0] & 0x0f) * 128 + data[1]);
+
+            if (! queueEvent (time, data, size) && ! pendingNoteOffs[key])
+            {
+                pendingNoteOffs.set (key);
+                ++numPendingNoteOffs;
+            }
+
+            continue;
+        }
+
+        // a note that's still waiting to be let go of has to be before it comes back
+        const bool noteOffFirst = isNoteOn (data, size) && ! queuePendingNoteOff (time, data[0] & 0x0f, data[1]);
+        const bool givesWay = isContinuous (data, size) && eventFifo.getFreeSpace() <= eventFifo.getTotalSize() / 4;
+
+        if (noteOffFirst || givesWay || ! queueEvent (time, data, size))
+            numDroppedEvents.fetch_add (1, std::memory_order_relaxed);
+    }
+
+    midiMessages.clear();
+
+    // then whatever audio is ready
+    const int numChannels = juce::jmin (buffer.getNumChannels(), ring.getNumChannels());
+    int numRead = 0;
+
+    {
+        const auto scope = audioFifo->read (numSamples);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            if (scope.blockSize1 > 0)
+                buffer.copyFrom (channel, 0, ring, channel, scope.startIndex1, scope.blockSize1);
+
+            if (scope.blockSize2 > 0)
+                buffer.copyFrom (channel, scope.blockSize1, ring, channel, scope.startIndex2, scope.blockSize2);
+        }
+
+        numRead = scope.blockSize1 + scope.blockSize2;
+    }
+
+    for (int channel = numChannels; channel < buffer.getNumChannels(); ++channel)
+        buffer.clear (channel, 0, numSamples);
+
+    if (numRead < numSamples)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            buffer.clear (channel, numRead, numSamples - numRead);
+
+        // the render thread skips what we couldn't play, so the delay stays put
+        samplesToDrop.fetch_add (numSamples - numRead, std::memory_order_relaxed);
+        numUnderruns.fetch_add (1, std::memory_order_relaxed);
+    }
+
+    devicePosition += numSamples;
+}
+
+bool RenderAhead::queueEvent (juce::int64 time, const juce::uint8* data, int size) noexcept
+{
+    const auto scope = eventFifo.write (1);
+
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+        return false;
+
+    auto& event = events[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)];
+    event.time = time;
+    event.size = (juce::uint8) size;
+    std::copy (data, data + size, event.data);
+    return true;
+}
+
+// False if there's one for the note and it still doesn't fit
+bool RenderAhead::queuePendingNoteOff (juce::int64 time, int channel, int noteNumber) noexcept
+{
+    const auto index = (size_t) (channel * 128 + noteNumber);
+
+    if (! pendingNoteOffs[index])
+        return true;
+
+    const juce::uint8 data[] = { (juce::uint8) (0x80 | channel), (juce::uint8) noteNumber, 0 };
+
+    if (! queueEvent (time, data, 3))
+        return false;
+
+    pendingNoteOffs.reset (index);
+    --numPendingNoteOffs;
+    return true;
+}
+
+void RenderAhead::queuePendingNoteOffs (juce::int64 time) noexcept
+{
+    for (int i = 0; i < (int) pendingNoteOffs.size() && numPendingNoteOffs > 0; ++i)
+        if (! queuePendingNoteOff (time, i / 128, i % 128))
+            return;
+}
+
+//==============================================================================
+void RenderAhead::run()
+{
+    const auto waitMs = juce::jmax (1, juce::roundToInt (500.0 * blockSize / sampleRate));
+
+    while (! threadShouldExit())
+    {
+        if (audioFifo->getFreeSpace() >= blockSize)
+            renderBlock();
+        else
+            wait (waitMs);
+    }
+}
+
+void RenderAhead::renderBlock()
+{
+    const auto blockEnd = renderPosition + blockSize;
+
+    // The events due in this block. They were queued in time order, and none
+    // can be due before renderPosition (see start()).
+    renderMidi.clear();
+
+    {
+        const auto ready = eventFifo.getNumReady();
+        int numDue = 0;
+        int start1, size1, start2, size2;
+        eventFifo.prepareToRead (ready, start1, size1, start2, size2);
+
+        for (int i = 0; i < size1 + size2; ++i)
+        {
+            const auto& event = events[(size_t) (i < size1 ? start1 + i : start2 + i - size1)];
+
+            if (event.time >= blockEnd)
+                break;
+
+            renderMidi.addEvent (event.data, event.size, (int) juce::jlimit ((juce::int64) 0, (juce::int64) blockSize - 1, event.time - renderPosition));
+            ++numDue;
+        }
+
+        eventFifo.finishedRead (numDue);
+    }
+
+    // There's no live input this far ahead, so it always starts from silence
+    renderBuffer.clear();
+    render (renderBuffer, renderMidi);
+    renderPosition = blockEnd;
+
+    // Whatever the device has already given up on goes
+    const auto toDrop = juce::jmin (blockSize, samplesToDrop.load (std::memory_order_relaxed));
+    samplesToDrop.fetch_sub (toDrop, std::memory_order_relaxed);
+
+    const auto scope = audioFifo->write (blockSize - toDrop);
+
+    for (int channel = 0; channel < ring.getNumChannels(); ++channel)
+    {
+        const auto sourceChannel = juce::jmin (channel, renderBuffer.getNumChannels() - 1);
+
+        if (scope.blockSize1 > 0)
+            ring.copyFrom (channel, scope.startIndex1, renderBuffer, sourceChannel, toDrop, scope.blockSize1);
+
+        if (scope.blockSize2 > 0)
+            ring.copyFrom (channel, scope.startIndex2, renderBuffer, sourceChannel, toDrop + scope.blockSize1, scope.blockSize2);
+    }
+}
@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    RenderAhead.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <bitset>
+
+// Render-ahead for the Standalone app: the synth runs on its own thread a few
+// blocks ahead of the audio device, and the device callback only copies out
+// what's ready.
+//
+// With processBlock straight in the device callback, one late wake-up of the
+// audio thread is an xrun, however light the load. Here the render thread
+// keeps a ring (an AbstractFifo) topped up with latencySamples of audio, so
+// it can be held up by up to that long without anything being heard. The
+// device callback never waits and never locks: it copies out of the ring and
+// pushes the block's MIDI into a second FIFO, stamped latencySamples into the
+// future, and the render thread plays each event at exactly that point. The
+// whole thing is a fixed delay: timing between events is kept to the sample.
+//
+// If the ring runs dry anyway, the callback plays silence for the missing
+// part and counts an underrun; the render thread drops the same amount when
+// it catches up, so the delay stays what it was.
+//
+// The MIDI queue holds an event per sample of the delay (at least
+// minQueuedEvents). Should it fill up regardless, controllers, pitch bend and
+// pressure give way first: they only go in while a quarter of the queue is
+// free, which leaves that quarter for notes. A note off that still doesn't
+// fit waits on the device side for the next callback, so none is ever lost.
+// Whatever else doesn't fit is counted (getNumDroppedEvents).
+//
+// Float only, for a single processor; start() and stop() belong to the
+// message thread while the device callback isn't running (hold the
+// processor's callback lock).
+class RenderAhead  : private juce::Thread
+{
+public:
+    using RenderFunction = std::function<void (juce::AudioBuffer<float>&, juce::MidiBuffer&)>;
+
+    explicit RenderAhead (RenderFunction functionToRender);
+    ~RenderAhead() override;
+
+    // Renders blockSize samples at a time, blocksAhead blocks ahead of the device
+    void start (double sampleRate, int blockSize, int numChannels, int blocksAhead);
+    void stop();
+
+    // After stop(): the MIDI the device handed over that was never played
+    // (and any note offs still waiting to go in), in order and all at sample
+    // 0, so nothing (a note off especially) is lost on the way back to
+    // rendering in the callback
+    void takeQueuedEvents (juce::MidiBuffer& dest);
+
+    bool isActive() const noexcept    { return active.load (std::memory_order_acquire); }
+
+    int getLatencySamples() const noexcept    { return latencySamples; }
+
+    // Since start()
+    int getNumUnderruns() const noexcept      { return numUnderruns.load (std::memory_order_relaxed); }
+    int getNumDroppedEvents() const noexcept  { return numDroppedEvents.load (std::memory_order_relaxed); }
+
+    // The device callback, in place of processBlock
+    void process (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) noexcept;
+
+private:
+    void run() override;
+    void renderBlock();
+
+    // Anything longer (sysex) isn't passed on
+    struct TimedEvent
+    {
+        juce::int64 time;
+        juce::uint8 data[3];
+        juce::uint8 size;
+    };
+
+    static constexpr int minQueuedEvents = 4096;
+
+    bool queueEvent (juce::int64 time, const juce::uint8* data, int size) noexcept;
+    bool queuePendingNoteOff (juce::int64 time, int channel, int noteNumber) noexcept;
+    void queuePendingNoteOffs (juce::int64 time) noexcept;
+
+    RenderFunction render;
+
+    std::atomic<bool> active { false };
+    double sampleRate = 44100.0;
+    int blockSize = 0;
+    int latencySamples = 0;
+
+    // device callback -> render thread
+    juce::AbstractFifo eventFifo { minQueuedEvents };
+    std::vector<TimedEvent> events;
+    std::atomic<int> samplesToDrop { 0 };
+    std::atomic<int> numDroppedEvents { 0 };
+
+    // the device callback's: note offs that didn't fit in the queue yet, by
+    // channel * 128 + note
+    std::bitset<16 * 128> pendingNoteOffs;
+    int numPendingNoteOffs = 0;
+
+    // render thread -> device callback
+    std::unique_ptr<juce::AbstractFifo> audioFifo;
+    juce::AudioBuffer<float> ring;
+    std::atomic<int> numUnderruns { 0 };
+
+    // each side's own clock, in samples since start()
+    juce::int64 devicePosition = 0;
+    juce::int64 renderPosition = 0;
+
+    // the render thread's
+    juce::AudioBuffer<float> renderBuffer;
+    juce::MidiBuffer renderMidi;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderAhead)
+};
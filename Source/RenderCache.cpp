@@ -0,0 +1,603 @@
+/*
+  ==============================================================================
+
+    RenderCache.cpp
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "RenderCache.h"
+
+namespace
+{
+    // Every chunk starts 16-byte aligned, in the pool and in the file
+    size_t alignTo16 (size_t size) noexcept    { return (size + 15) & ~(size_t) 15; }
+
+    // File layout: the header, then every note as a NoteHeader followed by its
+    // chunks. Native byte order; it's a cache, not an interchange format.
+    constexpr char fileMagic[8] = { '1', 'x', 'O', 's', 'c', 'R', 'C', '1' };
+    constexpr juce::uint32 fileVersion = 2;
+
+    struct FileHeader
+    {
+        char magic[8];
+        juce::uint32 version;
+        juce::uint32 stateSize;
+        juce::uint32 chunkSize;
+        juce::uint32 numNotes;
+        juce::uint64 layout;        // of the state, see the constructor
+    };
+
+    struct NoteHeader
+    {
+        juce::uint64 key;
+        juce::uint32 numChunks;
+        juce::uint32 reserved;
+    };
+
+    static_assert (sizeof (FileHeader) == 32 && sizeof (NoteHeader) == 16, "The chunks have to stay aligned");
+
+    // Checks the header, then calls noteFound (key, firstChunk, numChunks)
+    // for each whole note in the file. A file from another build of the voice
+    // is fine, it just has no notes that fit.
+    template <typename Callback>
+    juce::Result readNotes (const juce::MemoryMappedFile& mapping, size_t stateSize, juce::uint64 layout, size_t chunkBytes,
+                            Callback&& noteFound)
+    {
+        const auto* data = static_cast<const char*> (mapping.getData());
+        const auto size = mapping.getSize();
+        const auto fileName = mapping.getFile().getFullPathName();
+
+        if (data == nullptr)
+            return juce::Result::fail ("Can't map " + fileName);
+
+        FileHeader header;
+
+        if (size < sizeof (header))
+            return juce::Result::fail (fileName + " isn't a render cache");
+
+        std::memcpy (&header, data, sizeof (header));
+
+        if (std::memcmp (header.magic, fileMagic, sizeof (fileMagic)) != 0 || header.version != fileVersion)
+            return juce::Result::fail (fileName + " isn't a render cache");
+
+        if (header.stateSize != stateSize || header.layout != layout || header.chunkSize != (juce::uint32) RenderCache::chunkSize)
+            return juce::Result::ok();
+
+        size_t position = sizeof (header);
+
+        for (juce::uint32 i = 0; i < header.numNotes; ++i)
+        {
+            NoteHeader note;
+
+            if (position + sizeof (note) > size)
+                break;
+
+            std::memcpy (&note, data + position, sizeof (note));
+            position += sizeof (note);
+
+            const auto noteBytes = (size_t) note.numChunks * chunkBytes;
+
+            if (note.numChunks < 2 || position + noteBytes > size)
+                break;
+
+            if (! noteFound (note.key, data + position, note.numChunks))
+                break;
+
+            position += noteBytes;
+        }
+
+        return juce::Result::ok();
+    }
+
+    // Every instance in the process that saves to the same file merges into
+    // what the one before it wrote, so they go one at a time
+    juce::CriticalSection saveLock;
+}
+
+RenderCache::RenderCache (size_t stateSizeInBytes, juce::uint64 stateLayout)
+    : stateSize (stateSizeInBytes),
+      stateBytes (alignTo16 (stateSizeInBytes)),
+      chunkBytes (stateBytes + alignTo16 (chunkSize * sizeof (float))),
+      layout (stateLayout)
+{
+}
+
+RenderCache::~RenderCache()
+{
+}
+
+void RenderCache::prepare (double sampleRate, const Options& newOptions)
+{
+    const auto newNumChunks = (int) juce::jmin ((size_t) std::numeric_limits<int>::max(), newOptions.maxBytes / chunkBytes);
+    const auto newNumEntries = juce::jmax (1, newOptions.maxEntries);
+
+    if (newNumChunks != numChunks || newNumEntries != (int) entries.size())
+    {
+        release();
+
+        numChunks = newNumChunks;
+        pool.calloc ((size_t) numChunks * chunkBytes);
+        nextChunk.resize ((size_t) numChunks);
+        entries.resize ((size_t) newNumEntries);
+
+        // at most half full, so probes stay short
+        slots.assign (juce::nextPowerOfTwo (2 * newNumEntries), -1);
+        slotMask = slots.size() - 1;
+
+        for (int i = 0; i < numChunks; ++i)
+            nextChunk[(size_t) i] = i + 1 < numChunks ? i + 1 : -1;
+
+        firstFreeChunk = numChunks > 0 ? 0 : -1;
+    }
+
+    options = newOptions;
+
+    // the chunk holding the end state comes on top
+    maxChunksPerEntry = 1 + juce::jmax (1, (int) std::ceil (options.maxSeconds * sampleRate / chunkSize));
+
+    // the voices that were replaying or recording have gone
+    for (int i = 0; i < (int) entries.size(); ++i)
+    {
+        auto& entry = entries[(size_t) i];
+        entry.numReaders = 0;
+
+        if (entry.status == Status::recording)
+            freeEntry (i);
+    }
+}
+
+void RenderCache::release()
+{
+    dropMappedEntries();
+    mappedFile.reset();
+
+    pool.free();
+    numChunks = 0;
+    firstFreeChunk = -1;
+    nextChunk.clear();
+    entries.clear();
+    slots.clear();
+    slotMask = 0;
+    numComplete = 0;
+}
+
+//==============================================================================
+juce::Result RenderCache::load (const juce::File& file)
+{
+    dropMappedEntries();
+    mappedFile.reset();
+
+    if (! isPrepared())
+        return juce::Result::fail ("The render cache isn't prepared");
+
+    if (! file.existsAsFile())
+        return juce::Result::ok();
+
+    auto mapping = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+
+    const auto result = readNotes (*mapping, stateSize, layout, chunkBytes, [this] (juce::uint64 key, const char* chunks, juce::uint32 numChunksInNote)
+    {
+        if (find (key) >= 0)
+            return true;
+
+        const int index = allocateEntry (-1);
+
+        if (index < 0)
+            return false;
+
+        auto& entry = entries[(size_t) index];
+        entry.key = key;
+        entry.status = Status::complete;
+        entry.mapped = chunks;
+        entry.numChunks = (int) numChunksInNote;
+        addKey (index);
+        ++numComplete;
+        return true;
+    });
+
+    if (result.wasOk())
+        mappedFile = std::move (mapping);
+
+    return result;
+}
+
+juce::Result RenderCache::save (const juce::File& file)
+{
+    if (! isPrepared())
+        return juce::Result::fail ("The render cache isn't prepared");
+
+    const juce::ScopedLock sl (saveLock);
+
+    // What's in the file now may have been saved by another instance (or
+    // render job) since this one loaded it; the notes this one doesn't have
+    // are written back along with its own
+    std::unique_ptr<juce::MemoryMappedFile> existing;
+    std::vector<std::pair<const char*, NoteHeader>> keptNotes;
+
+    if (file.existsAsFile())
+    {
+        existing = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+
+        readNotes (*existing, stateSize, layout, chunkBytes, [this, &keptNotes] (juce::uint64 key, const char* chunks, juce::uint32 numChunksInNote)
+        {
+            const int index = find (key);
+
+            if (index < 0 || entries[(size_t) index].status != Status::complete)
+                keptNotes.push_back ({ chunks, NoteHeader { key, numChunksInNote, 0 } });
+
+            return true;
+        });
+    }
+
+    juce::TemporaryFile temp (file);
+
+    {
+        juce::FileOutputStream out (temp.getFile());
+
+        if (! out.openedOk())
+            return juce::Result::fail ("Can't write to " + temp.getFile().getFullPathName());
+
+        FileHeader header {};
+        std::memcpy (header.magic, fileMagic, sizeof (fileMagic));
+        header.version = fileVersion;
+        header.stateSize = (juce::uint32) stateSize;
+        header.chunkSize = (juce::uint32) chunkSize;
+        header.layout = layout;
+        header.numNotes = (juce::uint32) keptNotes.size();
+
+        for (auto& entry : entries)
+            if (entry.status == Status::complete)
+                ++header.numNotes;
+
+        out.write (&header, sizeof (header));
+
+        for (auto& entry : entries)
+        {
+            if (entry.status != Status::complete)
+                continue;
+
+            NoteHeader note { entry.key, (juce::uint32) entry.numChunks, 0 };
+            out.write (&note, sizeof (note));
+
+            Cursor cursor;
+            cursor.poolChunk = entry.firstChunk;
+
+            for (; cursor.chunk < entry.numChunks; moveToNextChunk (entry, cursor))
+                out.write (getChunk (entry, cursor), chunkBytes);
+        }
+
+        for (auto& [chunks, note] : keptNotes)
+        {
+            out.write (&note, sizeof (note));
+            out.write (chunks, (size_t) note.numChunks * chunkBytes);
+        }
+
+        out.flush();
+
+        if (out.getStatus().failed())
+            return out.getStatus();
+    }
+
+    // the file being replaced may be mapped, by this cache or just above
+    keptNotes.clear();
+    existing.reset();
+    dropMappedEntries();
+    mappedFile.reset();
+
+    if (! temp.overwriteTargetFileWithTemporary())
+        return juce::Result::fail ("Can't replace " + file.getFullPathName());
+
+    return load (file);
+}
+
+//==============================================================================
+bool RenderCache::startPlayback (juce::uint64 key, Cursor& cursor) noexcept
+{
+    const int index = find (key);
+
+    if (index < 0 || entries[(size_t) index].status != Status::complete)
+    {
+        numMisses.fetch_add (1, std::memory_order_relaxed);
+        return false;
+    }
+
+    auto& entry = entries[(size_t) index];
+    ++entry.numReaders;
+    entry.lastUsed = ++clock;
+
+    cursor = {};
+    cursor.entry = index;
+    cursor.poolChunk = entry.firstChunk;
+
+    numHits.fetch_add (1, std::memory_order_relaxed);
+    return true;
+}
+
+int RenderCache::read (Cursor& cursor, float* dest, int numSamples) noexcept
+{
+    jassert (cursor.isActive() && ! cursor.recording);
+
+    const auto& entry = entries[(size_t) cursor.entry];
+    int done = 0;
+
+    // the last chunk has no samples, only the state at the end
+    while (done < numSamples && cursor.chunk < entry.numChunks - 1)
+    {
+        const int num = juce::jmin (numSamples - done, chunkSize - cursor.offset);
+        const auto* samples = reinterpret_cast<const float*> (getChunk (entry, cursor) + stateBytes);
+
+        juce::FloatVectorOperations::copy (dest + done, samples + cursor.offset, num);
+        done += num;
+        cursor.offset += num;
+
+        if (cursor.offset == chunkSize)
+            moveToNextChunk (entry, cursor);
+    }
+
+    return done;
+}
+
+const void* RenderCache::getState (const Cursor& cursor) const noexcept
+{
+    jassert (cursor.isActive());
+    return getChunk (entries[(size_t) cursor.entry], cursor);
+}
+
+//==============================================================================
+bool RenderCache::startRecording (juce::uint64 key, Cursor& cursor, const void* state) noexcept
+{
+    if (! isPrepared() || find (key) >= 0)
+        return false;
+
+    const int index = allocateEntry (-1);
+
+    if (index < 0)
+        return false;
+
+    auto& entry = entries[(size_t) index];
+    entry.key = key;
+    entry.status = Status::recording;
+    entry.lastUsed = ++clock;
+    addKey (index);
+
+    cursor = {};
+    cursor.entry = index;
+    cursor.recording = true;
+
+    if (addChunk (cursor, state))
+        return true;
+
+    freeEntry (index);
+    cursor = {};
+    return false;
+}
+
+void RenderCache::write (Cursor& cursor, const float* source, int numSamples) noexcept
+{
+    jassert (cursor.isActive() && cursor.recording && numSamples <= getSpaceInChunk (cursor));
+
+    auto* samples = reinterpret_cast<float*> (getPoolChunk (cursor.poolChunk) + stateBytes);
+    juce::FloatVectorOperations::copy (samples + cursor.offset, source, numSamples);
+    cursor.offset += numSamples;
+}
+
+bool RenderCache::addChunk (Cursor& cursor, const void* state) noexcept
+{
+    jassert (cursor.isActive() && cursor.recording);
+
+    auto& entry = entries[(size_t) cursor.entry];
+
+    if (entry.numChunks >= maxChunksPerEntry)
+        return false;
+
+    const int chunk = allocateChunk (cursor.entry);
+
+    if (chunk < 0)
+        return false;
+
+    if (cursor.poolChunk >= 0)
+        nextChunk[(size_t) cursor.poolChunk] = chunk;
+    else
+        entry.firstChunk = chunk;
+
+    nextChunk[(size_t) chunk] = -1;
+    std::memcpy (getPoolChunk (chunk), state, stateSize);
+
+    cursor.chunk = entry.numChunks++;
+    cursor.poolChunk = chunk;
+    cursor.offset = 0;
+    return true;
+}
+
+void RenderCache::finish (Cursor& cursor) noexcept
+{
+    if (! cursor.isActive())
+        return;
+
+    auto& entry = entries[(size_t) cursor.entry];
+
+    if (! cursor.recording)
+    {
+        --entry.numReaders;
+    }
+    else if (entry.numChunks >= 2)
+    {
+        // anything in the last chunk is dropped, its state is the end
+        entry.status = Status::complete;
+        ++numComplete;
+    }
+    else
+    {
+        freeEntry (cursor.entry);
+    }
+
+    cursor = {};
+}
+
+//==============================================================================
+int RenderCache::find (juce::uint64 key) const noexcept
+{
+    if (slots.empty())
+        return -1;
+
+    for (auto slot = getHomeSlot (key);; slot = (slot + 1) & slotMask)
+    {
+        const int index = slots[slot];
+
+        if (index < 0)
+            return -1;
+
+        if (entries[(size_t) index].key == key)
+            return index;
+    }
+}
+
+size_t RenderCache::getHomeSlot (juce::uint64 key) const noexcept
+{
+    // the keys are FNV hashes already; this folds the high bits in
+    return (size_t) (key ^ (key >> 32)) & slotMask;
+}
+
+void RenderCache::addKey (int index) noexcept
+{
+    auto slot = getHomeSlot (entries[(size_t) index].key);
+
+    while (slots[slot] >= 0)
+        slot = (slot + 1) & slotMask;
+
+    slots[slot] = index;
+}
+
+void RenderCache::removeKey (int index) noexcept
+{
+    auto slot = getHomeSlot (entries[(size_t) index].key);
+
+    while (slots[slot] != index)
+        slot = (slot + 1) & slotMask;
+
+    // Backward shift: pulls later keys of the same run into the gap, so no
+    // tombstones pile up and find() can stop at the first empty slot
+    for (auto next = (slot + 1) & slotMask;; next = (next + 1) & slotMask)
+    {
+        slots[slot] = -1;
+
+        for (;; next = (next + 1) & slotMask)
+        {
+            if (slots[next] < 0)
+                return;
+
+            // a key stays if its home is cyclically in (slot, next]
+            const auto home = getHomeSlot (entries[(size_t) slots[next]].key);
+            const bool staysPut = slot <= next ? (slot < home && home <= next)
+                                               : (slot < home || home <= next);
+
+            if (! staysPut)
+                break;
+        }
+
+        slots[slot] = slots[next];
+        slot = next;
+    }
+}
+
+int RenderCache::allocateEntry (int entryToKeep) noexcept
+{
+    for (size_t i = 0; i < entries.size(); ++i)
+        if (entries[i].status == Status::empty)
+            return (int) i;
+
+    const int oldest = findLeastRecentlyUsed (entryToKeep, false);
+
+    if (oldest >= 0)
+        freeEntry (oldest);
+
+    return oldest;
+}
+
+int RenderCache::allocateChunk (int entryToKeep) noexcept
+{
+    while (firstFreeChunk < 0)
+    {
+        // only pooled notes give chunks back
+        const int oldest = findLeastRecentlyUsed (entryToKeep, true);
+
+        if (oldest < 0)
+            return -1;
+
+        freeEntry (oldest);
+    }
+
+    const int chunk = firstFreeChunk;
+    firstFreeChunk = nextChunk[(size_t) chunk];
+    return chunk;
+}
+
+int RenderCache::findLeastRecentlyUsed (int entryToKeep, bool pooledOnly) const noexcept
+{
+    int oldest = -1;
+
+    for (int i = 0; i < (int) entries.size(); ++i)
+    {
+        const auto& entry = entries[(size_t) i];
+
+        if (i == entryToKeep || entry.status != Status::complete || entry.numReaders > 0
+            || (pooledOnly && entry.mapped != nullptr))
+            continue;
+
+        // the clock wraps, so compare by age rather than by value
+        if (oldest < 0 || clock - entry.lastUsed > clock - entries[(size_t) oldest].lastUsed)
+            oldest = i;
+    }
+
+    return oldest;
+}
+
+void RenderCache::freeEntry (int index) noexcept
+{
+    auto& entry = entries[(size_t) index];
+
+    if (entry.status == Status::complete)
+        --numComplete;
+
+    if (entry.mapped == nullptr)
+    {
+        for (int chunk = entry.firstChunk; chunk >= 0;)
+        {
+            const int next = nextChunk[(size_t) chunk];
+            nextChunk[(size_t) chunk] = firstFreeChunk;
+            firstFreeChunk = chunk;
+            chunk = next;
+        }
+    }
+
+    if (entry.status != Status::empty)
+        removeKey (index);
+
+    entry = {};
+}
+
+void RenderCache::dropMappedEntries() noexcept
+{
+    for (int i = 0; i < (int) entries.size(); ++i)
+        if (entries[(size_t) i].mapped != nullptr)
+            freeEntry (i);
+}
+
+const char* RenderCache::getChunk (const Entry& entry, const Cursor& cursor) const noexcept
+{
+    if (entry.mapped != nullptr)
+        return entry.mapped + (size_t) cursor.chunk * chunkBytes;
+
+    return getPoolChunk (cursor.poolChunk);
+}
+
+void RenderCache::moveToNextChunk (const Entry& entry, Cursor& cursor) const noexcept
+{
+    ++cursor.chunk;
+    cursor.offset = 0;
+
+    if (entry.mapped == nullptr)
+        cursor.poolChunk = nextChunk[(size_t) cursor.poolChunk];
+}
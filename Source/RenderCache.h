@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+
+    RenderCache.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Keeps the rendered start of notes so the same note with the same patch can
+// be replayed instead of synthesised again.
+//
+// A note is recorded the first time it's played: its samples go into the
+// cache in chunks of chunkSize, each chunk starting with a copy of the voice's
+// render state at that point (an opaque block of stateSize bytes, see
+// SineWaveVoice::RenderState). The voice stops recording once the attack and
+// decay are over, when the note is released, or when the patch changes. The
+// chunk after the last whole one only keeps its state, which is where the
+// recording ends.
+//
+// Replaying hands over to live synthesis wherever it has to stop (the end of
+// what's cached, a note off, a patch change): the voice takes the state of
+// the chunk it's in and renders on from there to the current position, so
+// the oscillator carries on at exactly the phase the cached samples left it.
+// That's up to chunkSize - 1 samples nobody hears, so in real time every
+// hand-over that costs anything (a patch or quality change, a note off, a
+// steal) shares a budget per block (see claimHandOver). The voices past it
+// keep replaying for another block: the old sound, or with their release
+// worked out over the cached samples.
+//
+// Memory is one pool of chunks, allocated by prepare(). When it's full the
+// least recently played note that nobody is replaying is dropped. Notes are
+// found through an open-addressed hash of their keys. The cache
+// can be saved to a file and memory-mapped back in later (by another session
+// or another instance), so the next run starts with everything already
+// rendered; mapped notes don't take any of the pool. Saving merges into the
+// file: notes another instance saved there in the meantime are kept.
+//
+// Everything but prepare, release, load and save is allocation- and lock-free
+// and belongs to the audio thread. Those four are for the message thread
+// while nothing is rendering.
+class RenderCache
+{
+public:
+    static constexpr int chunkSize = 1024;
+
+    struct Options
+    {
+        size_t maxBytes = 64 * 1024 * 1024;
+        int maxEntries = 1024;
+        double maxSeconds = 4.0;    // recorded per note, at most
+    };
+
+    // stateLayout stands for the layout of the state (and anything else that
+    // makes recordings from another build unusable); files saved with a
+    // different one are ignored
+    RenderCache (size_t stateSizeInBytes, juce::uint64 stateLayout);
+    ~RenderCache();
+
+    // Allocates the pool if it hasn't been, or the options changed (which
+    // drops everything). Otherwise keeps what's cached and only forgets the
+    // voices that were using it.
+    void prepare (double sampleRate, const Options& newOptions);
+    void release();
+    bool isPrepared() const noexcept    { return numChunks > 0; }
+
+    // The file maps read-only; notes already in memory win over the file's.
+    // A missing file is fine (nothing's been saved yet). save() writes this
+    // cache's notes plus those in the file that it doesn't have; saves from
+    // instances in the same process take turns.
+    juce::Result load (const juce::File& file);
+    juce::Result save (const juce::File& file);
+
+    int getNumEntries() const noexcept  { return numComplete.load (std::memory_order_relaxed); }
+    int getNumHits() const noexcept     { return numHits.load (std::memory_order_relaxed); }
+    int getNumMisses() const noexcept   { return numMisses.load (std::memory_order_relaxed); }
+
+    // FNV-1a over the bytes of every value added
+    struct Hasher
+    {
+        template <typename Type>
+        Hasher& add (const Type& value) noexcept
+        {
+            static_assert (std::is_trivially_copyable_v<Type>, "Only plain values can be hashed");
+            const auto* bytes = reinterpret_cast<const unsigned char*> (&value);
+
+            for (size_t i = 0; i < sizeof (Type); ++i)
+                hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+
+            return *this;
+        }
+
+        juce::uint64 hash = 0xcbf29ce484222325ull;
+    };
+
+    // Where a voice is in the note it's replaying or recording
+    struct Cursor
+    {
+        int entry = -1;
+        int chunk = 0;          // counted from the start of the note
+        int poolChunk = -1;     // that chunk in the pool (-1 for mapped notes)
+        int offset = 0;         // samples into the chunk
+        bool recording = false;
+
+        bool isActive() const noexcept  { return entry >= 0; }
+    };
+
+    //==============================================================================
+    // Replaying. Returns false if the note isn't cached (or is still being
+    // recorded).
+    bool startPlayback (juce::uint64 key, Cursor& cursor) noexcept;
+
+    // Copies the next samples, up to numSamples. Fewer means the end of the
+    // note was reached, and the cursor is left on the state at the end.
+    int read (Cursor& cursor, float* dest, int numSamples) noexcept;
+
+    // The state at the start of the cursor's chunk; live rendering carries on
+    // cursor.offset samples after it
+    const void* getState (const Cursor& cursor) const noexcept;
+
+    //==============================================================================
+    // Recording. state is the voice's state before its first sample. Returns
+    // false if the note is already there or there's no room for it.
+    bool startRecording (juce::uint64 key, Cursor& cursor, const void* state) noexcept;
+
+    int getSpaceInChunk (const Cursor& cursor) const noexcept    { return chunkSize - cursor.offset; }
+
+    // At most getSpaceInChunk() samples
+    void write (Cursor& cursor, const float* source, int numSamples) noexcept;
+
+    // Starts the next chunk, once the current one is full. Returns false when
+    // the note has reached maxSeconds or the pool has no room left.
+    bool addChunk (Cursor& cursor, const void* state) noexcept;
+
+    //==============================================================================
+    // Stops replaying, or keeps what's been recorded. Fine on an idle cursor.
+    void finish (Cursor& cursor) noexcept;
+
+    // The samples the voices may spend on hand-overs this block; set at the
+    // start of every block
+    void setHandOverBudget (int numSamples) noexcept    { handOverSamplesLeft = numSamples; }
+
+    // True (and takes them from the budget) if a hand-over costing numSamples
+    // can go ahead this block. The first one always can.
+    bool claimHandOver (int numSamples) noexcept
+    {
+        if (handOverSamplesLeft <= 0)
+            return false;
+
+        handOverSamplesLeft -= numSamples;
+        return true;
+    }
+
+private:
+    enum class Status
+    {
+        empty,
+        recording,
+        complete
+    };
+
+    struct Entry
+    {
+        juce::uint64 key = 0;
+        Status status = Status::empty;
+        int firstChunk = -1;            // in the pool
+        const char* mapped = nullptr;   // or the first chunk in the mapped file
+        int numChunks = 0;
+        int numReaders = 0;
+        juce::uint32 lastUsed = 0;
+    };
+
+    int find (juce::uint64 key) const noexcept;
+    size_t getHomeSlot (juce::uint64 key) const noexcept;
+    void addKey (int index) noexcept;
+    void removeKey (int index) noexcept;
+    int allocateEntry (int entryToKeep) noexcept;
+    int allocateChunk (int entryToKeep) noexcept;
+    int findLeastRecentlyUsed (int entryToKeep, bool pooledOnly) const noexcept;
+    void freeEntry (int index) noexcept;
+    void dropMappedEntries() noexcept;
+
+    char* getPoolChunk (int index) const noexcept   { return pool.get() + (size_t) index * chunkBytes; }
+    const char* getChunk (const Entry& entry, const Cursor& cursor) const noexcept;
+    void moveToNextChunk (const Entry& entry, Cursor& cursor) const noexcept;
+
+    const size_t stateSize, stateBytes, chunkBytes;
+    const juce::uint64 layout;
+
+    Options options;
+    int maxChunksPerEntry = 0;
+
+    juce::HeapBlock<char> pool;
+    int numChunks = 0;
+    std::vector<int> nextChunk;         // the next chunk of the same note, or of the free list
+    int firstFreeChunk = -1;
+
+    std::vector<Entry> entries;
+    std::vector<int> slots;             // linear probing over the entries with a key, -1 for none
+    size_t slotMask = 0;
+    juce::uint32 clock = 0;
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+
+    std::atomic<int> numComplete { 0 }, numHits { 0 }, numMisses { 0 };
+    int handOverSamplesLeft = std::numeric_limits<int>::max();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderCache)
+};
@@ -0,0 +1,284 @@
+/*
+  ==============================================================================
+
+    SharedBudget.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "QualityGovernor.h"
+
+// One voice and CPU budget shared by every instance in the process.
+//
+// On their own, instances pick their polyphony and quality without knowing
+// about each other, so a session full of them can all peak in the same block.
+// Instances hold a SharedBudget::Member, and the ones that take part join(),
+// which claims a slot in the process-wide table (through a
+// juce::SharedResourcePointer); leave() hands it back for others. After
+// every block each one publishes its number of playing voices, how loud they
+// are (the sum of their current levels) and what the block cost (time taken /
+// time the block lasts, summed over instances that's roughly how many cores
+// the plugin keeps busy). Then it reads everybody's numbers and works out its
+// own part of any overrun:
+//
+//  - the instances are ranked from the quietest up, and whatever is over the
+//    budget comes out of the quietest first. An instance only gives up
+//    voices when the ones quieter than it don't have enough to cover the
+//    excess, and then only the rest (its quietest voices, faded out).
+//  - the same goes for the load: an instance whose quieter neighbours can't
+//    cover the overload steps its quality down (see QualityGovernor), one
+//    level at a time, and back up once it's been left alone for a while.
+//
+// Every instance decides for itself from the same shared counters: nothing is
+// locked, nobody waits for anybody, and a stale number only means a decision
+// lands a block late. Numbers that haven't been refreshed for staleAfterMs
+// (a bypassed or stopped instance) don't count.
+class SharedBudget
+{
+public:
+    static constexpr int maxInstances = 64;
+    static constexpr juce::uint32 staleAfterMs = 500;
+
+    struct Budget
+    {
+        int maxVoices = 128;
+        float maxLoad = 0.0f;   // summed block load, 0 = 0.75 per core
+    };
+
+    SharedBudget() = default;
+
+    void setBudget (const Budget& newBudget) noexcept
+    {
+        maxVoices.store (juce::jmax (1, newBudget.maxVoices), std::memory_order_relaxed);
+        maxLoad.store (newBudget.maxLoad > 0.0f ? newBudget.maxLoad : getDefaultMaxLoad(), std::memory_order_relaxed);
+    }
+
+    Budget getBudget() const noexcept
+    {
+        return { maxVoices.load (std::memory_order_relaxed), maxLoad.load (std::memory_order_relaxed) };
+    }
+
+    // Instances that published something recently
+    int getNumActiveInstances() const noexcept
+    {
+        const auto now = juce::Time::getMillisecondCounter();
+        int count = 0;
+
+        for (auto& slot : slots)
+            count += isCurrent (slot, now) ? 1 : 0;
+
+        return count;
+    }
+
+    //==============================================================================
+    // What an instance reports after each block
+    struct Report
+    {
+        int numVoices = 0;
+        float loudness = 0.0f;
+        float load = 0.0f;
+    };
+
+    // What it should do about it
+    struct Share
+    {
+        int voicesToSteal = 0;
+        bool overLoad = false;
+    };
+
+    class Member
+    {
+    public:
+        Member() = default;
+        ~Member()   { leave(); }
+
+        SharedBudget& getShared() noexcept    { return *shared; }
+        bool isRegistered() const noexcept    { return slot.load() >= 0; }
+
+        // Claims a slot if this instance hasn't got one yet. Returns false
+        // when the table is full, and it just doesn't take part.
+        bool join() noexcept
+        {
+            if (slot.load() < 0)
+                slot.store (shared->claimSlot());
+
+            return isRegistered();
+        }
+
+        // Gives the slot back and goes back to full quality. Not while
+        // blockFinished() is running.
+        void leave() noexcept
+        {
+            shared->releaseSlot (slot.exchange (-1));
+            changeLevel (0);
+        }
+
+        // Audio thread, after every realtime block. Returns the voices to
+        // give up now; the quality level is picked up with getLevelIndex().
+        int blockFinished (const Report& report, double blockSeconds) noexcept
+        {
+            const auto index = slot.load (std::memory_order_relaxed);
+
+            if (index < 0)
+                return 0;
+
+            const auto share = shared->publish (index, report);
+
+            timeOverLoad = share.overLoad ? timeOverLoad + blockSeconds : 0.0;
+            timeUnderLoad = share.overLoad ? 0.0 : timeUnderLoad + blockSeconds;
+
+            const auto current = level.load (std::memory_order_relaxed);
+
+            if (timeOverLoad >= degradeAfter && current < QualityGovernor::numLevels - 1)
+                changeLevel (current + 1);
+            else if (timeUnderLoad >= restoreAfter && current > 0)
+                changeLevel (current - 1);
+
+            return share.voicesToSteal;
+        }
+
+        // Stops counting towards the budget for now (e.g. rendering offline)
+        // but keeps the slot, and goes back to full quality
+        void stop() noexcept
+        {
+            const auto index = slot.load (std::memory_order_relaxed);
+
+            if (index >= 0)
+                shared->clearSlot (index);
+
+            changeLevel (0);
+        }
+
+        // The quality level the budget asks of this instance; any thread
+        int getLevelIndex() const noexcept    { return level.load (std::memory_order_relaxed); }
+
+    private:
+        static constexpr double degradeAfter = 0.05;   // seconds of audio, as QualityGovernor
+        static constexpr double restoreAfter = 2.0;
+
+        void changeLevel (int newLevel) noexcept
+        {
+            level.store (newLevel, std::memory_order_relaxed);
+            timeOverLoad = timeUnderLoad = 0.0;
+        }
+
+        juce::SharedResourcePointer<SharedBudget> shared;
+        std::atomic<int> slot { -1 };
+
+        std::atomic<int> level { 0 };
+        double timeOverLoad = 0.0;
+        double timeUnderLoad = 0.0;
+
+        JUCE_DECLARE_NON_COPYABLE (Member)
+    };
+
+private:
+    struct Slot
+    {
+        std::atomic<bool> used { false };
+        std::atomic<juce::uint32> updated { 0 };   // ms counter of the last report, 0 = none
+        std::atomic<int> numVoices { 0 };
+        std::atomic<float> loudness { 0.0f };
+        std::atomic<float> load { 0.0f };
+    };
+
+    static float getDefaultMaxLoad()
+    {
+        return 0.75f * static_cast<float> (juce::SystemStats::getNumCpus());
+    }
+
+    static bool isCurrent (const Slot& slot, juce::uint32 now) noexcept
+    {
+        const auto updated = slot.updated.load (std::memory_order_acquire);
+        return updated != 0 && slot.used.load (std::memory_order_relaxed) && now - updated < staleAfterMs;
+    }
+
+    // A total order, quietest first (the slot breaks ties)
+    static bool isQuieter (float loudness, int index, float otherLoudness, int otherIndex) noexcept
+    {
+        return loudness < otherLoudness || (loudness == otherLoudness && index < otherIndex);
+    }
+
+    int claimSlot() noexcept
+    {
+        for (int i = 0; i < maxInstances; ++i)
+        {
+            bool expected = false;
+
+            if (slots[(size_t) i].used.compare_exchange_strong (expected, true))
+            {
+                clearSlot (i);
+                return i;
+            }
+        }
+
+        // full: this instance just doesn't take part
+        return -1;
+    }
+
+    void releaseSlot (int index) noexcept
+    {
+        if (index < 0)
+            return;
+
+        clearSlot (index);
+        slots[(size_t) index].used.store (false);
+    }
+
+    void clearSlot (int index) noexcept
+    {
+        slots[(size_t) index].updated.store (0, std::memory_order_release);
+    }
+
+    Share publish (int index, const Report& report) noexcept
+    {
+        auto& own = slots[(size_t) index];
+        own.numVoices.store (report.numVoices, std::memory_order_relaxed);
+        own.loudness.store (report.loudness, std::memory_order_relaxed);
+        own.load.store (report.load, std::memory_order_relaxed);
+
+        // never 0, which means "nothing reported"
+        const auto now = juce::jmax ((juce::uint32) 1, juce::Time::getMillisecondCounter());
+        own.updated.store (now, std::memory_order_release);
+
+        int totalVoices = 0, quieterVoices = 0;
+        float totalLoad = 0.0f, quieterLoad = 0.0f;
+
+        for (int i = 0; i < maxInstances; ++i)
+        {
+            const auto& slot = slots[(size_t) i];
+
+            if (i != index && ! isCurrent (slot, now))
+                continue;
+
+            const auto voices = i == index ? report.numVoices : slot.numVoices.load (std::memory_order_relaxed);
+            const auto load = i == index ? report.load : slot.load.load (std::memory_order_relaxed);
+            totalVoices += voices;
+            totalLoad += load;
+
+            if (i != index && isQuieter (slot.loudness.load (std::memory_order_relaxed), i, report.loudness, index))
+            {
+                quieterVoices += voices;
+                quieterLoad += load;
+            }
+        }
+
+        Share share;
+        const auto excessVoices = totalVoices - maxVoices.load (std::memory_order_relaxed);
+        share.voicesToSteal = juce::jlimit (0, report.numVoices, excessVoices - quieterVoices);
+
+        const auto excessLoad = totalLoad - maxLoad.load (std::memory_order_relaxed);
+        share.overLoad = excessLoad > 0.0f && quieterLoad < excessLoad && report.load > 0.0f;
+        return share;
+    }
+
+    std::array<Slot, maxInstances> slots;
+    std::atomic<int> maxVoices { Budget().maxVoices };
+    std::atomic<float> maxLoad { getDefaultMaxLoad() };
+
+    JUCE_DECLARE_NON_COPYABLE (SharedBudget)
+};
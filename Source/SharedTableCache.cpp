@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    SharedTableCache.cpp
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "SharedTableCache.h"
+
+SharedTableCache::SharedTableCache()
+{
+}
+
+SharedTableCache::~SharedTableCache()
+{
+    // By now nobody holds an entry, so running builds see shouldStop() and return
+    pool.removeAllJobs (true, 10000);
+}
+
+int SharedTableCache::getNumEntries() const
+{
+    const juce::ScopedLock sl (lock);
+    return entries.size();
+}
+
+void SharedTableCache::startBuild (Entry* entry, std::function<std::shared_ptr<const void>()> build)
+{
+    pool.addJob ([entry, build = std::move (build)]
+    {
+        if (auto table = build())
+        {
+            entry->storage = std::move (table);
+            entry->table.store (entry->storage.get(), std::memory_order_release);
+        }
+        else
+        {
+            entry->failed = true;
+        }
+
+        entry->finished.signal();
+        return juce::ThreadPoolJob::jobHasFinished;
+    });
+}
+
+void SharedTableCache::removeUnusedEntries()
+{
+    for (int i = entries.size(); --i >= 0;)
+    {
+        auto* entry = entries.getUnchecked (i);
+
+        if (entry->isFinished() && entry->getReferenceCount() == 1)
+            entries.remove (i);
+    }
+}
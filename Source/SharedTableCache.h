@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    SharedTableCache.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Precomputed tables (pitch tables, wavetable mips, ...) shared by every
+// instance of the plugin in the process. Get at it with
+//
+//     juce::SharedResourcePointer<SharedTableCache> cache;
+//
+// so there's one cache while at least one instance is alive.
+//
+// Tables are looked up by type, source and sample rate. The first instance to
+// ask for a table gets it built on the cache's background threads; everyone
+// asking for the same key afterwards shares that one copy. Until it's ready
+// Entry::get() returns nullptr and the caller uses its own (cheap) fallback,
+// so neither construction nor prepareToPlay ever waits for a table.
+//
+// An entry stays alive as long as somebody holds its EntryPtr. Tables nobody
+// holds any more are dropped the next time something is looked up.
+class SharedTableCache
+{
+public:
+    SharedTableCache();
+    ~SharedTableCache();
+
+    struct Key
+    {
+        juce::String type;          // what kind of table, e.g. "pitch"
+        juce::String source;        // what it's built from (e.g. a file), if anything
+        double sampleRate = 0.0;    // 0 for tables that don't depend on it
+
+        bool operator== (const Key& other) const noexcept
+        {
+            return type == other.type && source == other.source && sampleRate == other.sampleRate;
+        }
+    };
+
+    class Entry : public juce::ReferenceCountedObject
+    {
+    public:
+        explicit Entry (const Key& k) : key (k) {}
+
+        const Key key;
+
+        // Lock-free, fine on the audio thread. nullptr until the table is built.
+        template <typename TableType>
+        const TableType* get() const noexcept
+        {
+            return static_cast<const TableType*> (table.load (std::memory_order_acquire));
+        }
+
+        bool isReady() const noexcept       { return table.load (std::memory_order_acquire) != nullptr; }
+        bool hasFailed() const noexcept     { return failed.load(); }
+        bool isFinished() const noexcept    { return isReady() || hasFailed(); }
+
+        // For offline use (e.g. before a bounce), where the fallback would make
+        // the result depend on timing. Not for the audio thread.
+        bool waitUntilReady (int timeoutMilliseconds) const
+        {
+            return finished.wait (timeoutMilliseconds) && isReady();
+        }
+
+    private:
+        friend class SharedTableCache;
+
+        std::shared_ptr<const void> storage;
+        std::atomic<const void*> table { nullptr };
+        std::atomic<bool> failed { false };
+        juce::WaitableEvent finished { true };
+
+        JUCE_DECLARE_NON_COPYABLE (Entry)
+    };
+
+    using EntryPtr = juce::ReferenceCountedObjectPtr<Entry>;
+
+    // Runs on a background thread. Can give up (return nullptr) when
+    // shouldStop() says nobody wants the table any more.
+    template <typename TableType>
+    using Builder = std::function<std::unique_ptr<TableType> (const std::function<bool()>& shouldStop)>;
+
+    // Returns the entry for the key, starting a build if there isn't one yet
+    // (or the last attempt failed)
+    template <typename TableType>
+    EntryPtr getOrCreate (const Key& key, Builder<TableType> build)
+    {
+        const juce::ScopedLock sl (lock);
+
+        removeUnusedEntries();
+
+        for (auto* entry : entries)
+            if (entry->key == key && ! entry->hasFailed())
+                return entry;
+
+        EntryPtr entry (new Entry (key));
+        entries.add (entry);
+
+        // A raw pointer is fine here: unfinished entries never leave the array,
+        // and the pool is stopped before the array goes
+        startBuild (entry.get(), [rawEntry = entry.get(), build = std::move (build)]() -> std::shared_ptr<const void>
+        {
+            // only the cache itself is still holding the entry
+            auto shouldStop = [rawEntry] { return rawEntry->getReferenceCount() <= 1; };
+            return std::shared_ptr<const TableType> (build (shouldStop));
+        });
+
+        return entry;
+    }
+
+    int getNumEntries() const;
+
+private:
+    void startBuild (Entry* entry, std::function<std::shared_ptr<const void>()> build);
+    void removeUnusedEntries();
+
+    juce::CriticalSection lock;
+    juce::ReferenceCountedArray<Entry> entries;
+
+    // last, so the threads are stopped before anything else is torn down
+    juce::ThreadPool pool { 2 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SharedTableCache)
+};
@@ -13,6 +13,19 @@
 class SineWaveSound : public juce::SynthesiserSound
 {
 public:
+    SineWaveSound() = default;
+
+    // In multi-timbral mode there's one sound per part, each listening to a
+    // single MIDI channel. All of them can be played by any voice in the pool.
+    SineWaveSound (int part, int channel)
+        : partIndex (part), midiChannel (channel) {}
+
     bool appliesToNote (int) override { return true; }
-    bool appliesToChannel (int) override { return true; }
+    bool appliesToChannel (int channel) override { return midiChannel <= 0 || channel == midiChannel; }
+
+    int getPartIndex() const { return partIndex; }
+
+private:
+    int partIndex = 0;
+    int midiChannel = 0; // 0 = omni
 };
@@ -1,6 +1,16 @@
 #pragma once
 
 #include "SineWaveSound.h"
+#include "PatchSnapshot.h"
+#include "AudioThreadGuard.h"
+#include "OscillatorKernels.h"
+#include "KernelDispatch.h"
+#include "VoiceFilter.h"
+#include "PitchTable.h"
+#include "BlockEnvelope.h"
+#include "QualityGovernor.h"
+#include "RenderCache.h"
+#include "Tracer.h"
 
 class SineWaveVoice : public juce::SynthesiserVoice
 {
@@ -11,7 +21,8 @@ public:
         Triangle,
         Saw,
         Square,
-        Noise
+        Noise,
+        Wavetable
     };
     
     float coarseTune = 0.0f;
@@ -34,6 +45,11 @@ public:
         filterEnvelopeParams.release = 0.1f;
 
         filterEnvelope.setParameters(filterEnvelopeParams);
+        noteTemplate.filterEnvelope.setParameters(filterEnvelopeParams);
+        
+        setNoiseSeed(1);
+        updatePartialLevels();
+        oscState.partialLevels = partialLevels.data();
     }
 
     bool canPlaySound (juce::SynthesiserSound* sound) override
@@ -44,14 +60,21 @@ public:
     void setCurrentPlaybackSampleRate(double newRate) override
     {
         SynthesiserVoice::setCurrentPlaybackSampleRate(newRate);
+        adsr.setSampleRate(newRate);
         filterEnvelope.setSampleRate(newRate);
-        filter.prepare({ newRate, 512, 1 });
+        noteTemplate.filterEnvelope.setSampleRate(newRate);
+        filter.prepare(newRate);
+        doubleFilter.prepare(newRate);
+        filterOpensAtTop = VoiceFilter<float>::isTransparentAtTop(newRate, filterResonance);
     }
     
     void setFilterParams(float cutoff, float resonance,
-                         juce::dsp::StateVariableFilter::Parameters<float>::Type type,
+                         VoiceFilterType type,
                          float envAmount)
     {
+        if (resonance != filterResonance)
+            filterOpensAtTop = VoiceFilter<float>::isTransparentAtTop(getSampleRate(), resonance);
+        
         filterCutoff = cutoff;
         filterResonance = resonance;
         filterType = type;
@@ -59,57 +82,124 @@ public:
     }
 
     void startNote (int midiNoteNumber, float velocity,
-                    juce::SynthesiserSound*, int) override
+                    juce::SynthesiserSound* sound, int) override
     {
+        ONEXOSC_AUDIO_THREAD_SCOPE("SineWaveVoice::startNote");
+        ONEXOSC_TRACE_SCOPE("noteOn");
+        
+        if (auto* oscSound = dynamic_cast<SineWaveSound*> (sound))
+            partIndex = oscSound->getPartIndex();
+        
+        // a stolen voice lets go of whatever it was replaying or recording
+        endReleaseFromCache();
+        
+        if (renderCache != nullptr)
+            renderCache->finish(cacheCursor);
+        
+        const bool startsFromSilence = ! adsr.isActive();
+
+        // Everything here is a copy or a table lookup: the patch-dependent
+        // set-up was done in applyPatch, so a chord costs the same per note
+        // whatever the patch, and nothing allocates, logs or calls pow()
         noteNumber = midiNoteNumber;
-        currentAngle = 0.0;
+        fadingOut = false;
+        oscState.phase = 0;
+        oscState.partialEnvelope.fill(1.0f);
         level = velocity;
-        tailOff = 0.0;
-        frequency = juce::MidiMessage::getMidiNoteInHertz(midiNoteNumber);
         updateFrequency();
         
-        adsr.noteOn();
-        filterEnvelope.setParameters(filterEnvelopeParams);
-        filterEnvelope.reset();
+        adsr.noteOn(); // from its current level, so a stolen voice doesn't click
+        filterEnvelope = noteTemplate.filterEnvelope;
         filterEnvelope.noteOn();
-        filter.prepare({ getSampleRate(), 512, 1 });
+        filter.reset();
+        doubleFilter.reset();
+        filterStarting = true;
+        
+        // the supersaw's start phases come from this voice's table, so the
+        // same notes always render the same
+        oscState.unisonPhases = startPhases[(size_t) nextStartPhases];
+        nextStartPhases = (nextStartPhases + 1) % numStartPhaseSets;
         
-        // randomize the supersaw phases
-        for (int i = 0; i < 7; ++i)
+        // A note that starts from silence renders the same every time, so it
+        // can come from the cache, or go into it
+        if (startsFromSilence && isCacheable())
         {
-            detunedPhases[i] = juce::Random::getSystemRandom().nextDouble() * juce::MathConstants<double>::twoPi;
+            cachedSoundKey = getSoundKey();
+            const auto key = RenderCache::Hasher().add(cachedSoundKey).add(noteNumber)
+                                                  .add(level).add(oscState.phaseIncrement).hash;
+            
+            if (! renderCache->startPlayback(key, cacheCursor))
+            {
+                const auto state = getRenderState();
+                renderCache->startRecording(key, cacheCursor, &state);
+            }
         }
     }
 
     void stopNote (float /*velocity*/, bool allowTailOff) override
     {
         if (allowTailOff)
+        {
+            // the release is never cached: it goes live if this block's
+            // hand-over budget allows, or runs over the replay until it does
+            if (! tryHandOverToLive())
             {
-                adsr.noteOff();
-                filterEnvelope.noteOff();
-            }
-            else
-            {
-                adsr.reset();
-                filterEnvelope.reset();
-                clearCurrentNote();
+                releaseFromCache(false);
+                return;
             }
+            
+            adsr.noteOff();
+            filterEnvelope.noteOff();
+        }
+        else
+        {
+            releasingFromCache = false;
+            
+            if (renderCache != nullptr)
+                renderCache->finish(cacheCursor);
+            
+            adsr.reset();
+            filterEnvelope.reset();
+            clearCurrentNote();
+        }
     }
     
-    void setADSR(const juce::ADSR::Parameters& newParams)
+    // Stolen to stay within the shared budget: a few milliseconds' release
+    // from wherever the voice is, so it goes quickly but without a click
+    void fadeOut()
+    {
+        if (tryHandOverToLive())
+        {
+            adsr.quickRelease(0.005);
+            filterEnvelope.noteOff();
+        }
+        else
+        {
+            releaseFromCache(true);
+        }
+        
+        fadingOut = true;
+    }
+    
+    bool isFadingOut() const { return fadingOut; }
+    
+    // Where the voice is now: envelope, velocity and part level
+    float getCurrentLevel() const
+    {
+        return (releasingFromCache ? replayRelease : adsr).getCurrentValue() * level * partLevel;
+    }
+    
+    void setADSR(const BlockEnvelope::Parameters& newParams)
     {
         adsrParams = newParams;
         adsr.setParameters(adsrParams);  // Apply the new ADSR settings
     }
     
-    void setFilterADSR(const juce::ADSR::Parameters& newParams)
+    void setFilterADSR(const BlockEnvelope::Parameters& newParams)
     {
-        juce::Logger::writeToLog("setFilterADSR called: A=" + juce::String(newParams.attack) +
-                                 ", D=" + juce::String(newParams.decay) +
-                                 ", S=" + juce::String(newParams.sustain) +
-                                 ", R=" + juce::String(newParams.release));
         filterEnvelopeParams = newParams;
         filterEnvelope.setParameters(filterEnvelopeParams);
+        noteTemplate.filterEnvelope.setParameters(filterEnvelopeParams);
     }
     
     void setCoarseTune(float newValue)
@@ -129,204 +219,838 @@ public:
         special = newValue;
     }
     
+    // Picks up whatever changed in the patch. Called every block, so anything
+    // with a cost (tuning, envelope rates) is only touched when it differs.
+    void applyPatch(const PatchSnapshot& patch, bool usePatchLevel)
+    {
+        // A replayed note goes live before anything changes, while the voice
+        // still renders what the cache has
+        if (renderCache != nullptr)
+        {
+            const auto newPatchHash = hashPatch(patch, usePatchLevel);
+            
+            // past this block's hand-over budget the note replays the old
+            // patch for one more block and tries again
+            if (newPatchHash != patchHash)
+            {
+                if (! tryHandOverToLive())
+                    return;
+                
+                patchHash = newPatchHash;
+            }
+        }
+        
+        setMode(patch.wavetable ? OscillatorMode::Wavetable : modeFromIndex(patch.waveform));
+        
+        if (patch.coarseTune != coarseTune || patch.fineTune != fineTune)
+        {
+            coarseTune = patch.coarseTune;
+            fineTune = patch.fineTune;
+            
+            // idle voices pick the tuning up in startNote
+            if (isVoiceActive())
+                updateFrequency();
+        }
+        
+        if (patch.attack != adsrParams.attack || patch.decay != adsrParams.decay
+            || patch.sustain != adsrParams.sustain || patch.release != adsrParams.release)
+        {
+            setADSR({ patch.attack, patch.decay, patch.sustain, patch.release });
+        }
+        
+        // the filter's decay and release share a knob
+        if (patch.filterAttack != filterEnvelopeParams.attack || patch.filterDecayRelease != filterEnvelopeParams.decay
+            || patch.filterSustain != filterEnvelopeParams.sustain || patch.filterDecayRelease != filterEnvelopeParams.release)
+        {
+            setFilterADSR({ patch.filterAttack, patch.filterDecayRelease, patch.filterSustain, patch.filterDecayRelease });
+        }
+        
+        setSpecial(patch.special);
+        
+        if (patch.numPartials != numPartials || patch.partialTilt != partialTilt)
+        {
+            numPartials = std::clamp(patch.numPartials, 1, OscillatorKernels::maxPartials);
+            partialTilt = patch.partialTilt;
+            updatePartialLevels();
+        }
+        
+        // log2 per sample per harmonic above the fundamental: at 1, harmonic 2
+        // falls 60 dB in a second and harmonic h in 1 / (h - 1) seconds
+        oscState.partialDecay = getSampleRate() > 0.0
+                                    ? -patch.partialDecay * 10.0f / static_cast<float>(getSampleRate())
+                                    : 0.0f;
+        
+        auto type = VoiceFilterType::lowPass;
+        if (patch.filterType == 1) type = VoiceFilterType::bandPass;
+        else if (patch.filterType == 2) type = VoiceFilterType::highPass;
+        
+        setFilterParams(std::clamp(patch.filterCutoff, 20.0f, 20000.0f),
+                        std::clamp(patch.filterResonance, 0.1f, 10.0f),
+                        type,
+                        patch.filterAmount / 100.0f); // -1.0 to 1.0
+        
+        partLevel = usePatchLevel ? patch.level : 1.0f;
+        
+        if (patch.stereoWidth != stereoWidth)
+        {
+            stereoWidth = patch.stereoWidth;
+            updatePanGains();
+        }
+    }
+    
+    int getPartIndex() const { return partIndex; }
+    
+    static OscillatorMode modeFromIndex(int index)
+    {
+        if (index == 1) return OscillatorMode::Triangle;
+        if (index == 2) return OscillatorMode::Saw;
+        if (index == 3) return OscillatorMode::Square;
+        if (index == 4) return OscillatorMode::Noise;
+        return OscillatorMode::Sine;
+    }
+    
     void updateFrequency()
     {
         // Apply coarse (in semitones) and fine (fraction of a semitone) tuning
-        double semitoneOffset = coarseTune + fineTune;
-        double baseFrequency = juce::MidiMessage::getMidiNoteInHertz(noteNumber);
-        tunedFrequency = baseFrequency * std::pow(2.0, semitoneOffset / 12.0);
-        angleDelta = juce::MathConstants<double>::twoPi * tunedFrequency / getSampleRate();
-
-        // Log values to desktop log file
-        juce::Logger::writeToLog("updateFrequency | coarseTune: " + juce::String(coarseTune) +
-                                 ", fineTune: " + juce::String(fineTune) +
-                                 ", tunedFrequency: " + juce::String(tunedFrequency));
+        const double pitch = noteNumber + static_cast<double>(coarseTune + fineTune);
+        
+        // the shared table if it's there for this rate, otherwise work it out
+        // (only until the table has been built, just after prepareToPlay)
+        if (pitchTable != nullptr && pitchTable->getSampleRate() == getSampleRate())
+            oscState.phaseIncrement = pitchTable->getIncrement(pitch);
+        else
+            oscState.phaseIncrement = PitchTable::incrementForPitch(pitch, getSampleRate());
     }
     
     float getFilterEnvelopeValue() const { return filterEnvelopeValue; }
+    
+    // The envelopes as rendered for the last chunk of renderVoiceBlock (up to
+    // envelopeBlockSize samples), for anything else modulated by them
+    static constexpr int envelopeBlockSize = 64;
+    const float* getAmpEnvelopeBlock() const { return ampEnvelopeBlock.data(); }
+    const float* getFilterEnvelopeBlock() const { return filterEnvelopeBlock.data(); }
 
+    // Gains for the left and right output, from the voice's place in the
+    // stereo spread. Both are 1 in the centre, so a width of 0 is plain mono.
+    struct PanGains
+    {
+        float left = 1.0f;
+        float right = 1.0f;
+    };
+    
+    void setSpreadPosition(float newPosition)
+    {
+        spreadPosition = juce::jlimit(-1.0f, 1.0f, newPosition);
+        updatePanGains();
+    }
+    
+    PanGains getPanGains() const { return panGains; }
+    
+    // Adds this voice into the buffer. OscSynthesiser doesn't go through here,
+    // it renders into its per-voice scratch blocks with renderVoiceBlock and
+    // mixes them itself, but plain juce::Synthesiser code still works.
     void renderNextBlock (juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override
     {
-        if (angleDelta == 0.0)
-            return;
+        addVoiceTo(outputBuffer, startSample, numSamples);
+    }
+    
+    void renderNextBlock (juce::AudioBuffer<double>& outputBuffer, int startSample, int numSamples) override
+    {
+        addVoiceTo(outputBuffer, startSample, numSamples);
+    }
+    
+    // Renders the (mono) voice into dest, replacing its contents. Returns false
+    // without touching dest if the voice is idle. SampleType is the host's
+    // precision: the oscillator writes straight into it, and the filter and
+    // gain run in it, so a double-precision host gets no float round trip.
+    template <typename SampleType>
+    bool renderVoiceBlock (SampleType* dest, int numSamples)
+    {
+        ONEXOSC_AUDIO_THREAD_SCOPE("SineWaveVoice::renderVoiceBlock");
+        
+        if constexpr (std::is_same_v<SampleType, float>)
+            if (cacheCursor.isActive())
+                return renderCachedBlock(dest, numSamples);
+        
+        return renderLiveBlock(dest, numSamples);
+    }
+    
+    // Everything renderVoiceBlock changes as it goes. The render cache keeps
+    // one at the start of every chunk it records, for replayed notes to carry
+    // on from when they go live.
+    struct RenderState
+    {
+        juce::uint32 phase;
+        std::array<juce::uint32, OscillatorKernels::numUnisonVoices> unisonPhases;
+        juce::uint32 noiseState;
+        std::array<float, OscillatorKernels::maxPartials> partialEnvelope;
+        BlockEnvelope adsr;
+        BlockEnvelope filterEnvelope;
+        VoiceFilter<float> filter;
+        float filterEnvelopeValue;
+        bool filterBypassed;
+        bool filterStarting;
+    };
+    
+    static_assert(std::is_trivially_copyable_v<RenderState>, "The render cache copies RenderState as bytes");
+    
+    // Tells the render cache which RenderState its files were saved with. The
+    // sizes catch most changes; bump renderStateVersion for the ones they
+    // don't (a field's meaning, or what the kernels render).
+    static juce::uint64 getRenderStateLayout()
+    {
+        constexpr juce::uint32 renderStateVersion = 1;
+        
+        return RenderCache::Hasher().add(renderStateVersion).add(sizeof(RenderState)).add(sizeof(void*))
+                                    .add(OscillatorKernels::numUnisonVoices).add(OscillatorKernels::maxPartials)
+                                    .add(sizeof(BlockEnvelope)).add(sizeof(VoiceFilter<float>)).hash;
+    }
+    
+    // Notes with a deterministic patch are replayed from (or recorded into)
+    // the cache. nullptr turns it off. Only used by float hosts.
+    void setRenderCache(RenderCache* cache)
+    {
+        endReleaseFromCache();
+        
+        if (renderCache != nullptr)
+            renderCache->finish(cacheCursor);
+        
+        renderCache = cache;
+        patchHash = 0;
+    }
+    
+    // Draft maths for live playback, exact for offline bounces
+    void setMathAccuracy(FastMath::Accuracy newAccuracy)
+    {
+        mathAccuracy = newAccuracy;
+    }
+    
+    // Set by the processor from the quality governor's current level
+    void setQuality(const QualityGovernor::Level& quality)
+    {
+        oscState.maxHarmonics = quality.maxHarmonics;
+        oscState.numUnison = quality.numUnisonVoices;
+        filterUpdateInterval = juce::jmax(1, quality.filterUpdateInterval);
+        releaseStealLevel = quality.releaseStealLevel;
+    }
+
+    void pitchWheelMoved (int) override {}
+    void controllerMoved (int, int) override {}
 
-        auto numChannels = outputBuffer.getNumChannels();
+    void setMode(OscillatorMode newMode)
+    {
+        mode = newMode;
+    }
+    
+    // The user wavetable for the Wavetable mode (nullptr while none is loaded).
+    // Has to stay alive for as long as the voice renders with it.
+    void setWavetable(const Wavetable* table)
+    {
+        oscState.wavetable = table;
+    }
+    
+    void setPitchTable(const PitchTable* table)
+    {
+        pitchTable = table;
+    }
+    
+    // Gives each voice its own noise sequence and start phases. Not for the
+    // audio thread: it fills the voice's start phase table.
+    void setNoiseSeed(juce::uint32 seed)
+    {
+        noiseSeed = seed;
+        oscState.noiseState = seed != 0 ? seed : 0x9e3779b9u;
+        
+        juce::Random random (static_cast<juce::int64>(seed));
+        
+        for (auto& phases : startPhases)
+            for (auto& phase : phases)
+                phase = static_cast<juce::uint32>(random.nextInt());
+        
+        nextStartPhases = 0;
+    }
+    
+    // Back to the start of the voice's noise sequence and start phases, as
+    // if it had just been given its seed
+    void restartNoise()
+    {
+        setNoiseSeed(noiseSeed);
+    }
 
-        for (int sample = 0; sample < numSamples; ++sample)
+private:
+    OscillatorKernels::Shape getShape() const
+    {
+        switch (mode)
+        {
+            case OscillatorMode::Sine:     return OscillatorKernels::Shape::sine;
+            case OscillatorMode::Triangle: return OscillatorKernels::Shape::triangle;
+            case OscillatorMode::Saw:      return special > 0.0f ? OscillatorKernels::Shape::supersaw
+                                                                : OscillatorKernels::Shape::saw;
+            case OscillatorMode::Square:   return OscillatorKernels::Shape::square;
+            case OscillatorMode::Noise:    return OscillatorKernels::Shape::noise;
+            case OscillatorMode::Wavetable: return OscillatorKernels::Shape::wavetable;
+        }
+        
+        return OscillatorKernels::Shape::sine;
+    }
+    
+    OscillatorKernels::State oscState;
+    const KernelDispatch::Table& kernels = KernelDispatch::get(); // picked for this CPU
+    OscillatorKernels::Function<float> oscKernel = nullptr;
+    OscillatorKernels::Function<double> doubleOscKernel = nullptr;
+    OscillatorKernels::Shape currentShape = OscillatorKernels::Shape::sine;
+    FastMath::Accuracy mathAccuracy = FastMath::Accuracy::exact;
+    FastMath::Accuracy kernelAccuracy = FastMath::Accuracy::exact;
+    const PitchTable* pitchTable = nullptr;
+    
+    // What startNote copies, kept up to date with the patch by applyPatch
+    struct NoteTemplate
+    {
+        BlockEnvelope filterEnvelope; // idle, with the patch's rates worked out
+    };
+    
+    NoteTemplate noteTemplate;
+    
+    // Supersaw start phases, handed out in turn
+    static constexpr int numStartPhaseSets = 64;
+    std::array<std::array<juce::uint32, OscillatorKernels::numUnisonVoices>, numStartPhaseSets> startPhases {};
+    int nextStartPhases = 0;
+    
+    template <typename SampleType>
+    bool renderLiveBlock (SampleType* dest, int numSamples)
+    {
+        if (oscState.phaseIncrement == 0)
+            return false;
+        
+        // Under CPU pressure, a released voice that's nearly silent is cut
+        // instead of rendering the rest of its tail
+        if (releaseStealLevel > 0.0f && isPlayingButReleased()
+            && adsr.getCurrentValue() * level < releaseStealLevel)
         {
-            float sampleValue = 0.0f;
+            adsr.reset();
+            filterEnvelope.reset();
+            clearCurrentNote();
+            oscState.phaseIncrement = 0;
+            return false;
+        }
+        
+        // Pick the oscillator kernel once for the whole block
+        oscState.special = special;
+        const auto shape = getShape();
+        
+        if (shape != currentShape || kernelAccuracy != mathAccuracy || oscKernel == nullptr)
+        {
+            oscKernel = kernels.floatKernels.getOscillator(shape, mathAccuracy);
+            doubleOscKernel = kernels.doubleKernels.getOscillator(shape, mathAccuracy);
+            currentShape = shape;
+            kernelAccuracy = mathAccuracy;
+        }
+        
+        {
+            ONEXOSC_TRACE_SCOPE("oscillator");
+            
+            if constexpr (std::is_same_v<SampleType, double>)
+                doubleOscKernel(oscState, dest, numSamples);
+            else
+                oscKernel(oscState, dest, numSamples);
+        }
 
-            switch (mode)
+        // then envelopes, filter and level on top of it
+        switch (mathAccuracy)
+        {
+            case FastMath::Accuracy::draft:   return processEnvelopesAndFilter<FastMath::Accuracy::draft>(dest, numSamples);
+            case FastMath::Accuracy::precise: return processEnvelopesAndFilter<FastMath::Accuracy::precise>(dest, numSamples);
+            case FastMath::Accuracy::exact:   return processEnvelopesAndFilter<FastMath::Accuracy::exact>(dest, numSamples);
+        }
+        
+        return true;
+    }
+    
+    // A replayed note comes straight from the cache until it has to go live; a
+    // recorded one renders live and is copied in chunk by chunk
+    bool renderCachedBlock(float* dest, int numSamples)
+    {
+        ONEXOSC_TRACE_SCOPE("render cache");
+        
+        // The quality or the maths changed under the note, or it's releasing
+        // over the replay: it goes live once the hand-over budget has room,
+        // and replays the old sound until then
+        if (getSoundKey() != cachedSoundKey || releasingFromCache)
+            tryHandOverToLive();
+        
+        int done = 0;
+        
+        if (cacheCursor.isActive() && ! cacheCursor.recording)
+        {
+            done = renderCache->read(cacheCursor, dest, numSamples);
+            
+            // the amp envelope keeps time with the replay (a hand-over puts it
+            // back to the chunk's), so getCurrentLevel() still says how loud
+            // the note is and the budget doesn't take it for a quiet one
+            float envelope[envelopeBlockSize];
+            float release[envelopeBlockSize];
+            
+            for (int start = 0; start < done; start += envelopeBlockSize)
             {
-                case OscillatorMode::Sine:
+                const int num = juce::jmin(envelopeBlockSize, done - start);
+                adsr.render(envelope, num);
+                
+                if (! releasingFromCache)
+                    continue;
+                
+                // the recording was made with the note held: scale it from
+                // that envelope to the released one
+                const int numActive = replayRelease.render(release, num);
+                
+                for (int i = 0; i < num; ++i)
+                    dest[start + i] *= envelope[i] > 1.0e-4f ? release[i] / envelope[i] : 0.0f;
+                
+                if (numActive < num)
                 {
-                    sampleValue = 0.0f;
-
-                    // Dynamically compute number of harmonics based on 'special' (1 to 20)
-                    int maxHarmonics = static_cast<int>(1 + special * 20);  // 1 to 50 harmonics
-
-                    for (int h = 1; h <= maxHarmonics; ++h)
-                    {
-                        float amplitude = 1.0f / static_cast<float>(h);  // simple harmonic falloff
-                        sampleValue += amplitude * std::sin(currentAngle * h);
-                    }
-
-                    sampleValue *= 0.5f; // basic normalization (can be tuned further if needed)
-                    break;
-                }
-                case OscillatorMode::Triangle:
-                {
-                    // Desmos-based triangle with g = special
-                    // Mimics Arturia Minibrute metalizer
-                    double g =  special * 10 + 1;
-                    double phase = fmod(currentAngle / juce::MathConstants<double>::twoPi, 1.0); // 0 to 1
-
-                    double t = std::abs(fmod(phase, 1.0) - 0.5) * 2.0 * g;
-                    double a = std::min(t, 1.0) - std::max(t, 1.0) + 1.0;
-                    double b = std::max(a, 0.0) - std::min(a, 0.0);
-
-                    sampleValue = (float)b - 0.5;
-                    break;
+                    // released all the way before it could go live
+                    renderCache->finish(cacheCursor);
+                    releasingFromCache = false;
+                    adsr.reset();
+                    filterEnvelope.reset();
+                    clearCurrentNote();
+                    juce::FloatVectorOperations::clear(dest + start + numActive, numSamples - start - numActive);
+                    return true;
                 }
-                case OscillatorMode::Saw:
+            }
+            
+            if (done == numSamples)
+                return true;
+            
+            // that's all there is of it (free: the cursor is at the start of
+            // the last chunk)
+            handOverToLive();
+        }
+        
+        while (done < numSamples && cacheCursor.isActive())
+        {
+            const int num = juce::jmin(numSamples - done, renderCache->getSpaceInChunk(cacheCursor));
+            
+            if (! renderLiveBlock(dest + done, num))
+            {
+                renderCache->finish(cacheCursor);
+                break;
+            }
+            
+            renderCache->write(cacheCursor, dest + done, num);
+            done += num;
+            
+            if (! isVoiceActive())
+            {
+                // the note ended by itself
+                renderCache->finish(cacheCursor);
+            }
+            else if (renderCache->getSpaceInChunk(cacheCursor) == 0)
+            {
+                // the next chunk starts from here; the last one only keeps the
+                // state, once the attack and decay are over (both envelopes
+                // holding still) or there's no room for more
+                const auto state = getRenderState();
+                
+                if (! renderCache->addChunk(cacheCursor, &state)
+                    || (adsr.wasLastBlockConstant() && filterEnvelope.wasLastBlockConstant()))
+                    renderCache->finish(cacheCursor);
+            }
+        }
+        
+        if (done < numSamples && ! renderLiveBlock(dest + done, numSamples - done))
+            juce::FloatVectorOperations::clear(dest + done, numSamples - done);
+        
+        return true;
+    }
+    
+    // handOverToLive, if this block's budget has room for it (see
+    // RenderCache::claimHandOver). Always does for a note that isn't replaying.
+    bool tryHandOverToLive()
+    {
+        const int cost = cacheCursor.isActive() && ! cacheCursor.recording ? cacheCursor.offset : 0;
+        
+        if (cost > 0 && ! renderCache->claimHandOver(cost))
+            return false;
+        
+        handOverToLive();
+        return true;
+    }
+    
+    // Released (or faded out) while replaying, with no budget left to go
+    // live: the note carries on from the cache, with the release worked out
+    // from the amp envelope the recording had, until it can hand over
+    void releaseFromCache(bool quickly)
+    {
+        if (! releasingFromCache)
+        {
+            replayRelease = adsr;
+            releasingFromCache = true;
+        }
+        
+        if (quickly)
+            replayRelease.quickRelease(0.005);
+        else
+            replayRelease.noteOff();
+    }
+    
+    // The release carries on as the amp envelope (the filter envelope is
+    // still held, the replay can't do without it)
+    void endReleaseFromCache()
+    {
+        if (! releasingFromCache)
+            return;
+        
+        adsr = replayRelease;
+        releasingFromCache = false;
+    }
+    
+    // Carries on live from wherever the cache left the note: back to the state
+    // at the start of the chunk being replayed, then rendering (and throwing
+    // away) up to where the replay had got to, so the phase lines up exactly.
+    // Costs up to chunkSize - 1 samples, so in real time it goes through
+    // tryHandOverToLive, except where the cost is nothing.
+    void handOverToLive()
+    {
+        if (! cacheCursor.isActive())
+            return;
+        
+        // a recording note is live already
+        if (cacheCursor.recording)
+        {
+            renderCache->finish(cacheCursor);
+            return;
+        }
+        
+        RenderState state;
+        std::memcpy(&state, renderCache->getState(cacheCursor), sizeof(state));
+        int samplesToSkip = cacheCursor.offset;
+        renderCache->finish(cacheCursor);
+        setRenderState(state);
+        
+        float skipped[envelopeBlockSize];
+        
+        while (samplesToSkip > 0)
+        {
+            const int num = juce::jmin(samplesToSkip, envelopeBlockSize);
+            
+            if (! renderLiveBlock(skipped, num))
+                break;
+            
+            samplesToSkip -= num;
+        }
+        
+        // a release that started while replaying: the filter's starts now
+        if (releasingFromCache)
+        {
+            endReleaseFromCache();
+            filterEnvelope.noteOff();
+        }
+    }
+    
+    RenderState getRenderState() const
+    {
+        RenderState state;
+        state.phase = oscState.phase;
+        state.unisonPhases = oscState.unisonPhases;
+        state.noiseState = oscState.noiseState;
+        state.partialEnvelope = oscState.partialEnvelope;
+        state.adsr = adsr;
+        state.filterEnvelope = filterEnvelope;
+        state.filter = filter;
+        state.filterEnvelopeValue = filterEnvelopeValue;
+        state.filterBypassed = filterBypassed;
+        state.filterStarting = filterStarting;
+        return state;
+    }
+    
+    void setRenderState(const RenderState& state)
+    {
+        oscState.phase = state.phase;
+        oscState.unisonPhases = state.unisonPhases;
+        oscState.noiseState = state.noiseState;
+        oscState.partialEnvelope = state.partialEnvelope;
+        adsr = state.adsr;
+        filterEnvelope = state.filterEnvelope;
+        filter = state.filter;
+        filterEnvelopeValue = state.filterEnvelopeValue;
+        filterBypassed = state.filterBypassed;
+        filterStarting = state.filterStarting;
+        
+        // the envelopes carry on with the voice's settings, not the recording's
+        adsr.setParameters(adsrParams);
+        filterEnvelope.setParameters(filterEnvelopeParams);
+    }
+    
+    // Nothing random: no noise, no wavetable (it can change under the same
+    // patch) and no supersaw (its start phases rotate)
+    bool isCacheable() const
+    {
+        return renderCache != nullptr
+            && (mode == OscillatorMode::Sine || mode == OscillatorMode::Triangle || mode == OscillatorMode::Square
+                || (mode == OscillatorMode::Saw && special <= 0.0f));
+    }
+    
+    // Everything besides the note that decides what the voice renders
+    juce::uint64 getSoundKey() const
+    {
+        return RenderCache::Hasher().add(patchHash).add(mathAccuracy).add(oscState.maxHarmonics)
+                                    .add(oscState.numUnison).add(filterUpdateInterval).add(getSampleRate()).hash;
+    }
+    
+    // The stereo width is left out (it's applied in the mix), and so is the
+    // level when the processor applies it
+    static juce::uint64 hashPatch(const PatchSnapshot& patch, bool usePatchLevel)
+    {
+        RenderCache::Hasher hasher;
+        hasher.add(usePatchLevel);
+        
+        for (int i = 0; i < PatchSnapshot::numParameters; ++i)
+            if (i != PatchSnapshot::stereoWidthIndex && (usePatchLevel || i != PatchSnapshot::levelIndex))
+                hasher.add(patch.getValue(i));
+        
+        return hasher.hash;
+    }
+    
+    RenderCache* renderCache = nullptr;
+    RenderCache::Cursor cacheCursor;
+    juce::uint64 patchHash = 0;
+    juce::uint64 cachedSoundKey = 0;
+    
+    // see releaseFromCache
+    BlockEnvelope replayRelease;
+    bool releasingFromCache = false;
+    
+    template <typename SampleType>
+    void addVoiceTo(juce::AudioBuffer<SampleType>& outputBuffer, int startSample, int numSamples)
+    {
+        SampleType scratch[64];
+        
+        while (numSamples > 0)
+        {
+            const int numThisTime = juce::jmin(numSamples, (int) juce::numElementsInArray(scratch));
+            
+            if (! renderVoiceBlock(scratch, numThisTime))
+                return;
+            
+            for (int channel = 0; channel < outputBuffer.getNumChannels(); ++channel)
+            {
+                const float gain = channel == 0 ? panGains.left : (channel == 1 ? panGains.right : 1.0f);
+                outputBuffer.addFrom(channel, startSample, scratch, numThisTime, static_cast<SampleType>(gain));
+            }
+            
+            startSample += numThisTime;
+            numSamples -= numThisTime;
+        }
+    }
+    
+    template <typename SampleType>
+    VoiceFilter<SampleType>& getFilter()
+    {
+        if constexpr (std::is_same_v<SampleType, double>)
+            return doubleFilter;
+        else
+            return filter;
+    }
+    
+    template <FastMath::Accuracy accuracy, typename SampleType>
+    bool processEnvelopesAndFilter(SampleType* dest, int numSamples)
+    {
+        ONEXOSC_TRACE_SCOPE("envelopes + filter");
+        auto& voiceFilter = getFilter<SampleType>();
+        voiceFilter.setType(filterType);
+        const auto& blockKernels = kernels.get<SampleType>();
+        
+        // the cutoff is worked out in float whatever the sample type
+        const float cutoffRange = filterAmount * (20000.0f - 20.0f); // full range
+        const float gain = level * partLevel;
+        
+        for (int start = 0; start < numSamples; start += envelopeBlockSize)
+        {
+            const int num = juce::jmin(envelopeBlockSize, numSamples - start);
+            SampleType* block = dest + start;
+            
+            // Both envelopes for the whole chunk, then everything that uses them
+            const int numActive = adsr.render(ampEnvelopeBlock.data(), num);
+            filterEnvelope.render(filterEnvelopeBlock.data(), num);
+            filterEnvelopeValue = filterEnvelopeBlock[(size_t) num - 1];
+            
+            // With no envelope amount the cutoff stays put whatever the
+            // envelope does. A lowpass that's wide open is skipped altogether.
+            const bool cutoffConstant = filterEnvelope.wasLastBlockConstant() || filterAmount == 0.0f;
+            const float cutoff = std::clamp(filterCutoff + filterEnvelopeValue * cutoffRange, 20.0f, 20000.0f);
+            const bool bypass = cutoffConstant && filterOpensAtTop && filterType == VoiceFilterType::lowPass
+                                && cutoff >= VoiceFilter<float>::topCutoff;
+            
+            auto runFilter = [&]
+            {
+                if (cutoffConstant)
                 {
-                    if (special > 0.0f) {
-                        float detuneOffsets[7] = { -3.0f, -2.0f, -1.0f, 0.0f, 1.0f, 2.0f, 3.0f };
-                        sampleValue = 0.0f;
-                        
-                        for (int i = 0; i < 7; ++i)
-                        {
-                            float detune = detuneOffsets[i] * static_cast<float>(special/2.0f); // bring the range down a bit
-                            double freq = tunedFrequency * std::pow(2.0, detune / 12.0);
-                            double phaseDelta = juce::MathConstants<double>::twoPi * freq / getSampleRate();
-                            
-                            detunedPhases[i] += phaseDelta;
-                            if (detunedPhases[i] > juce::MathConstants<double>::twoPi)
-                                detunedPhases[i] -= juce::MathConstants<double>::twoPi;
-                            
-                            double phase = detunedPhases[i] / juce::MathConstants<double>::twoPi;
-                            double saw = 2.0 * phase - 1.0;
-                            
-                            sampleValue += static_cast<float>(saw);
-                        }
-                        
-                        sampleValue /= 7.0f;
-                        break;
-                    }
-                    else {
-                        // proper simple saw with wrapped phase
-                        double phase = fmod(currentAngle, juce::MathConstants<double>::twoPi) / juce::MathConstants<double>::twoPi;
-                        sampleValue = static_cast<float>(2.0 * phase - 1.0);
-                        break;
-                    }
+                    // sustaining: the cutoff is the same for the whole chunk
+                    voiceFilter.template setCutoff<accuracy>(cutoff, filterResonance);
+                    blockKernels.filter(voiceFilter, block, numActive);
+                    return;
                 }
-                case OscillatorMode::Square:
+                
+                // the cutoff follows the envelope every filterUpdateInterval
+                // samples (every sample at full quality)
+                for (int i = 0; i < numActive; i += filterUpdateInterval)
                 {
-                    // Pulse Width Modulation — center = 0.5, range = 0.01 to 0.99
-                    double pw = 0.5 + special * 0.49;
-                    double phase = fmod(currentAngle / juce::MathConstants<double>::twoPi, 1.0);
-                    sampleValue = (phase < pw) ? 1.0f : -1.0f;
-                    break;
+                    const float movingCutoff = std::clamp(filterCutoff + filterEnvelopeBlock[(size_t) i] * cutoffRange, 20.0f, 20000.0f);
+                    voiceFilter.template setCutoff<accuracy>(movingCutoff, filterResonance);
+                    
+                    const int end = juce::jmin(numActive, i + filterUpdateInterval);
+                    
+                    for (int j = i; j < end; ++j)
+                        block[j] = voiceFilter.processSample(block[j]);
                 }
-                case OscillatorMode::Noise:
+            };
+            
+            if (bypass == filterBypassed || filterStarting)
+            {
+                if (! bypass)
+                    runFilter();
+            }
+            else
+            {
+                // Going in or out of bypass: the chunk fades from what was
+                // playing to what will be. A filter coming back in starts
+                // from silence rather than from wherever it was left.
+                SampleType dry[envelopeBlockSize];
+                std::copy(block, block + numActive, dry);
+                
+                if (! bypass)
+                    voiceFilter.reset();
+                
+                runFilter();
+                
+                for (int i = 0; i < numActive; ++i)
                 {
-                    sampleValue = juce::Random::getSystemRandom().nextFloat() * 2.0f - 1.0f;
-                    break;
+                    const auto fade = static_cast<SampleType>(i + 1) / static_cast<SampleType>(numActive);
+                    const auto from = bypass ? block[i] : dry[i];
+                    const auto to = bypass ? dry[i] : block[i];
+                    block[i] = from + (to - from) * fade;
                 }
             }
-
-            float ampEnv = adsr.getNextSample();
-            filterEnvelopeValue = filterEnvelope.getNextSample();
             
-            // Apply envelope to filter cutoff
-            //float modulatedCutoff = filterCutoff * std::pow(2.0f, filterEnvelopeValue * filterAmount);
-            float modulatedCutoff = filterCutoff + filterEnvelopeValue * (filterAmount * (20000.0f - 20.0f)); // full range
-            modulatedCutoff = std::clamp(modulatedCutoff, 20.0f, 20000.0f);
-            //juce::Logger::writeToLog("env: " + juce::String(filterEnvelopeValue) + " modulatedCutoff: " + juce::String(modulatedCutoff));
+            filterBypassed = bypass;
+            filterStarting = false;
             
-            if (auto* params = filter.state.get())
+            // Envelope and level in one pass. A flat envelope (sustain) is
+            // just a gain, and at unity not even that.
+            if (adsr.wasLastBlockConstant() && numActive == num)
             {
-                params->setCutOffFrequency(getSampleRate(), modulatedCutoff, filterResonance);
-                params->type = filterType;
+                const float flatGain = ampEnvelopeBlock[0] * gain;
+                
+                if (flatGain != 1.0f)
+                    juce::FloatVectorOperations::multiply(block, static_cast<SampleType>(flatGain), num);
             }
-
-            float temp = sampleValue;
-            float* channelData[] = { &temp };
-
-            juce::dsp::AudioBlock<float> block(channelData, 1, 1); // 1 channel, 1 sample
-            juce::dsp::ProcessContextReplacing<float> context(block);
-            filter.process(context);
-
-            sampleValue = temp;
-            
-            float filtered = sampleValue;
-            
-            sampleValue = filtered * level * ampEnv;
-
-            if (tailOff > 0.0)
+            else
             {
-                sampleValue *= tailOff;
-                tailOff *= 0.99;
-
-                if (tailOff < 0.005)
-                {
-                    clearCurrentNote();
-                    angleDelta = 0.0;
-                    break;
-                }
+                blockKernels.applyGain(block, ampEnvelopeBlock.data(), gain, num);
             }
-
-            for (int channel = 0; channel < numChannels; ++channel)
-                outputBuffer.addSample(channel, startSample + sample, sampleValue);
-
-            currentAngle += angleDelta;
-
-            if (currentAngle > juce::MathConstants<double>::twoPi)
-                currentAngle -= juce::MathConstants<double>::twoPi;
             
-            if (!adsr.isActive())
-                {
-                    clearCurrentNote();
-                }
+            if (numActive < num)
+            {
+                // the envelope has finished: stop here so the voice goes
+                // idle instead of rendering silence from now on
+                clearCurrentNote();
+                oscState.phaseIncrement = 0;
+                juce::FloatVectorOperations::clear(dest + start + numActive, numSamples - start - numActive);
+                break;
+            }
         }
+        
+        return true;
     }
-
-    void pitchWheelMoved (int) override {}
-    void controllerMoved (int, int) override {}
-
-    void setMode(OscillatorMode newMode)
+    
+    float level = 0.0f;
+    float special = 0.0f;
+    
+    int noteNumber = -1;
+    int partIndex = 0;
+    float partLevel = 1.0f;
+    
+    int numPartials = 21;
+    float partialTilt = 1.0f;
+    std::array<float, OscillatorKernels::maxPartials> partialLevels {};
+    
+    // level_h = h^-tilt, scaled down whenever the partials add up to more than
+    // the default 21 at 1/h do, so piling them on never gets louder than that.
+    // Only runs when the patch changes, from a table so there's no pow()
+    void updatePartialLevels()
     {
-        mode = newMode;
+        static const auto log2Table = []
+        {
+            std::array<float, OscillatorKernels::maxPartials> table {};
+            
+            for (size_t i = 0; i < table.size(); ++i)
+                table[i] = std::log2(static_cast<float>(i + 1));
+            
+            return table;
+        }();
+        
+        static const auto referenceSum = []
+        {
+            float sum = 0.0f;
+            
+            for (size_t i = 0; i < 21; ++i)
+                sum += FastMath::exp2<FastMath::Accuracy::precise>(-log2Table[i]);
+            
+            return sum;
+        }();
+        
+        float sum = 0.0f;
+        
+        for (size_t i = 0; i < partialLevels.size(); ++i)
+        {
+            partialLevels[i] = static_cast<int>(i) < numPartials
+                                   ? FastMath::exp2<FastMath::Accuracy::precise>(-partialTilt * log2Table[i])
+                                   : 0.0f;
+            sum += partialLevels[i];
+        }
+        
+        if (sum > referenceSum)
+            juce::FloatVectorOperations::multiply(partialLevels.data(), referenceSum / sum, (int) partialLevels.size());
+        
+        oscState.numPartials = numPartials;
     }
-
-private:
-    double currentAngle = 0.0;
-    double angleDelta = 0.0;
-    double level = 0.0;
-    double frequency = 0.0;
-    double tailOff = 0.0;
-    double special = 0.0;
-    double tunedFrequency = 0.0;
-    double detunedPhases[7] = {};
     
-    int noteNumber = -1;
+    float stereoWidth = 0.0f;
+    float spreadPosition = 0.0f;
+    PanGains panGains;
+    
+    void updatePanGains()
+    {
+        // balance law: the far side is turned down, the near side stays at 1
+        const float pan = stereoWidth * spreadPosition;
+        panGains.left  = juce::jmin(1.0f, 1.0f - pan);
+        panGains.right = juce::jmin(1.0f, 1.0f + pan);
+    }
 
     OscillatorMode mode = OscillatorMode::Sine;
 
-    juce::ADSR adsr; // ADSR object for the voice envelope
-    juce::ADSR::Parameters adsrParams; // ADSR parameters that are controlled by the sliders
+    BlockEnvelope adsr; // ADSR object for the voice envelope
+    BlockEnvelope::Parameters adsrParams; // ADSR parameters that are controlled by the sliders
+    
+    BlockEnvelope filterEnvelope;
+    BlockEnvelope::Parameters filterEnvelopeParams;
     
-    juce::ADSR filterEnvelope;
-    juce::ADSR::Parameters filterEnvelopeParams;
+    std::array<float, envelopeBlockSize> ampEnvelopeBlock {};
+    std::array<float, envelopeBlockSize> filterEnvelopeBlock {};
     
-    juce::dsp::ProcessorDuplicator<
-        juce::dsp::StateVariableFilter::Filter<float>,
-        juce::dsp::StateVariableFilter::Parameters<float>
-    > filter;
+    // one per precision, the host only ever uses one of them
+    VoiceFilter<float> filter;
+    VoiceFilter<double> doubleFilter;
     
     float filterCutoff = 1000.0f;
     float filterResonance = 0.7f;
     float filterAmount = 0.0f;
-    juce::dsp::StateVariableFilter::Parameters<float>::Type filterType =
-        juce::dsp::StateVariableFilter::Parameters<float>::Type::lowPass;
+    bool filterOpensAtTop = false;  // see VoiceFilter::isTransparentAtTop
+    bool filterBypassed = false;    // for the last chunk
+    bool filterStarting = true;     // nothing's been through the filter since the note started
+    int filterUpdateInterval = 1;
+    float releaseStealLevel = 0.0f;
+    bool fadingOut = false;
+    juce::uint32 noiseSeed = 1;
+    VoiceFilterType filterType = VoiceFilterType::lowPass;
 };
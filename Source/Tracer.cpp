@@ -0,0 +1,195 @@
+/*
+  ==============================================================================
+
+    Tracer.cpp
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "Tracer.h"
+
+namespace Tracer
+{
+    namespace
+    {
+        struct Event
+        {
+            const char* name;
+            juce::int64 startTicks;
+            juce::int64 endTicks;
+            int id;
+        };
+
+        struct ThreadBuffer
+        {
+            std::unique_ptr<Event[]> events;
+            std::atomic<juce::uint64> numWritten { 0 };
+            std::atomic<juce::uint64> threadId { 0 };
+        };
+
+        constexpr int maxThreads = 16;
+        constexpr juce::uint64 eventsPerThread = 1 << 14;
+
+        std::array<ThreadBuffer, maxThreads> buffers;
+        std::atomic<int> numBuffersUsed { 0 };
+        std::atomic<int> session { 0 };
+        std::atomic<bool> running { false };
+        juce::CriticalSection controlLock;
+
+        // Threads inside record(). It checks running after counting itself
+        // in, so once running is false and this is 0 nobody touches the buffers.
+        std::atomic<int> numWriters { 0 };
+
+        void waitForWriters() noexcept
+        {
+            while (numWriters.load() > 0)
+                juce::Thread::yield();
+        }
+
+        // Which buffer this thread writes to, claimed on its first event of a session
+        thread_local ThreadBuffer* threadBuffer = nullptr;
+        thread_local int threadSession = -1;
+
+        ThreadBuffer* getThreadBuffer() noexcept
+        {
+            const auto currentSession = session.load (std::memory_order_acquire);
+
+            if (threadSession != currentSession)
+            {
+                threadSession = currentSession;
+                threadBuffer = nullptr;
+
+                const auto index = numBuffersUsed.fetch_add (1);
+
+                // more threads than buffers: the rest go unrecorded
+                if (index < maxThreads)
+                {
+                    threadBuffer = &buffers[(size_t) index];
+                    threadBuffer->threadId = (juce::uint64) (juce::pointer_sized_uint) juce::Thread::getCurrentThreadId();
+                }
+            }
+
+            return threadBuffer;
+        }
+    }
+
+    void start()
+    {
+        const juce::ScopedLock sl (controlLock);
+
+        running = false;
+        waitForWriters();
+
+        for (auto& buffer : buffers)
+        {
+            if (buffer.events == nullptr)
+                buffer.events.reset (new Event[eventsPerThread]);
+
+            buffer.numWritten = 0;
+            buffer.threadId = 0;
+        }
+
+        numBuffersUsed = 0;
+        ++session;
+        running = true;
+    }
+
+    void stop()
+    {
+        const juce::ScopedLock sl (controlLock);
+        running = false;
+        waitForWriters();
+    }
+
+    bool isRunning() noexcept
+    {
+        return running.load (std::memory_order_relaxed);
+    }
+
+    int getNumUntracedThreads() noexcept
+    {
+        return juce::jmax (0, numBuffersUsed.load() - maxThreads);
+    }
+
+    void record (const char* name, int id, juce::int64 startTicks, juce::int64 endTicks) noexcept
+    {
+        if (! isRunning())
+            return;
+
+        ++numWriters;
+
+        if (running.load())
+        {
+            if (auto* buffer = getThreadBuffer())
+            {
+                const auto index = buffer->numWritten.load (std::memory_order_relaxed);
+                buffer->events[index % eventsPerThread] = { name, startTicks, endTicks, id };
+                buffer->numWritten.store (index + 1, std::memory_order_release);
+            }
+        }
+
+        --numWriters;
+    }
+
+    juce::Result writeChromeTrace (const juce::File& file)
+    {
+        const juce::ScopedLock sl (controlLock);
+
+        if (running)
+            return juce::Result::fail ("Stop the trace before writing it");
+
+        const int numBuffers = juce::jmin (numBuffersUsed.load(), maxThreads);
+        const auto ticksPerMicrosecond = (double) juce::Time::getHighResolutionTicksPerSecond() / 1.0e6;
+        auto firstTicks = std::numeric_limits<juce::int64>::max();
+
+        for (int b = 0; b < numBuffers; ++b)
+        {
+            const auto& buffer = buffers[(size_t) b];
+            const auto count = buffer.numWritten.load (std::memory_order_acquire);
+
+            for (auto i = count > eventsPerThread ? count - eventsPerThread : 0; i < count; ++i)
+                firstTicks = juce::jmin (firstTicks, buffer.events[i % eventsPerThread].startTicks);
+        }
+
+        file.deleteFile();
+        juce::FileOutputStream out (file);
+
+        if (out.failedToOpen())
+            return juce::Result::fail ("Can't write to " + file.getFullPathName());
+
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        bool first = true;
+
+        for (int b = 0; b < numBuffers; ++b)
+        {
+            const auto& buffer = buffers[(size_t) b];
+            const auto count = buffer.numWritten.load (std::memory_order_acquire);
+            const auto tid = juce::String (b + 1);
+
+            out << (first ? "" : ",\n")
+                << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+                << ",\"args\":{\"name\":\"Thread " << tid << " (0x" << juce::String::toHexString ((juce::int64) buffer.threadId.load()) << ")\"}}";
+            first = false;
+
+            for (auto i = count > eventsPerThread ? count - eventsPerThread : 0; i < count; ++i)
+            {
+                const auto& event = buffer.events[i % eventsPerThread];
+
+                out << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                    << ",\"ts\":" << juce::String ((double) (event.startTicks - firstTicks) / ticksPerMicrosecond, 3)
+                    << ",\"dur\":" << juce::String ((double) (event.endTicks - event.startTicks) / ticksPerMicrosecond, 3);
+
+                if (event.id >= 0)
+                    out << ",\"args\":{\"id\":" << event.id << "}";
+
+                out << "}";
+            }
+        }
+
+        out << "\n],\"otherData\":{\"untracedThreads\":" << getNumUntracedThreads() << "}}\n";
+        out.flush();
+
+        return out.getStatus();
+    }
+}
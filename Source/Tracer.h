@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    Tracer.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Opt-in timeline profiler.
+//
+// ONEXOSC_TRACE_SCOPE marks a stretch of code (processBlock, the MIDI front
+// end, each voice's oscillator and filter, ...). While tracing is running,
+// every pass through a scope is recorded with its start and end time into a
+// buffer that belongs to the calling thread, so recording never locks or
+// allocates. The buffers are allocated by start() and hold the most recent
+// events (older ones are overwritten). There are buffers for 16 threads; any
+// more go unrecorded, and getNumUntracedThreads() says how many.
+//
+// stop() then writeChromeTrace() dumps everything as Chrome trace JSON, which
+// opens in chrome://tracing or ui.perfetto.dev, one track per thread.
+//
+// When tracing isn't running a scope costs one relaxed atomic load. Building
+// with ONEXOSC_TRACE=0 removes the scopes altogether.
+#ifndef ONEXOSC_TRACE
+ #define ONEXOSC_TRACE 1
+#endif
+
+namespace Tracer
+{
+    // Message thread (or whoever is in charge of the trace). stop() returns
+    // once no thread is still writing an event; scopes open across it are
+    // left out.
+    void start();
+    void stop();
+    bool isRunning() noexcept;
+
+    // Call after stop(). Writes every recorded event.
+    juce::Result writeChromeTrace (const juce::File& file);
+
+    // Threads that recorded nothing this session because the buffers ran out
+    int getNumUntracedThreads() noexcept;
+
+    void record (const char* name, int id, juce::int64 startTicks, juce::int64 endTicks) noexcept;
+
+    class Scope
+    {
+    public:
+        // name has to be a string literal (only the pointer is kept); id is
+        // shown as an argument, e.g. the voice number, and left out if < 0
+        Scope (const char* scopeName, int scopeId = -1) noexcept
+            : name (scopeName), id (scopeId),
+              startTicks (isRunning() ? juce::Time::getHighResolutionTicks() : 0)
+        {
+        }
+
+        ~Scope() noexcept
+        {
+            if (startTicks != 0)
+                record (name, id, startTicks, juce::Time::getHighResolutionTicks());
+        }
+
+    private:
+        const char* const name;
+        const int id;
+        const juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE (Scope)
+    };
+}
+
+#if ONEXOSC_TRACE
+ #define ONEXOSC_TRACE_SCOPE(name)          Tracer::Scope JUCE_JOIN_MACRO (traceScope_, __LINE__) (name)
+ #define ONEXOSC_TRACE_SCOPE_ID(name, id)   Tracer::Scope JUCE_JOIN_MACRO (traceScope_, __LINE__) (name, id)
+#else
+ #define ONEXOSC_TRACE_SCOPE(name)
+ #define ONEXOSC_TRACE_SCOPE_ID(name, id)
+#endif
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    VoiceFilter.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <complex>
+#include "FastMath.h"
+
+// Outside the template so the float and double filters take the same setting
+enum class VoiceFilterType
+{
+    lowPass,
+    bandPass,
+    highPass
+};
+
+// The per-voice state variable filter. Same topology and maths as
+// juce::dsp::StateVariableFilter (TPT, lowpass / bandpass / highpass taps), but
+// a single channel processed one sample at a time with no AudioBlock wrapping,
+// and with the tan() of the cutoff prewarp coming from FastMath so it can run
+// at the selected accuracy tier.
+//
+// SampleType is what the state and the taps run in. The coefficients are
+// always worked out in float: they're recomputed per sample while the filter
+// envelope moves, and float is plenty for a cutoff.
+template <typename SampleType>
+class VoiceFilter
+{
+public:
+    using Type = VoiceFilterType;
+
+    void prepare (double sampleRate) noexcept
+    {
+        piOverSampleRate = static_cast<float> (3.141592653589793 / sampleRate);
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        s1 = s2 = SampleType (0);
+    }
+
+    template <FastMath::Accuracy accuracy>
+    void setCutoff (float cutoffFrequency, float resonance) noexcept
+    {
+        g  = static_cast<SampleType> (FastMath::tan<accuracy> (cutoffFrequency * piOverSampleRate));
+        R2 = static_cast<SampleType> (1.0f / resonance);
+        h  = static_cast<SampleType> (1) / (static_cast<SampleType> (1) + R2 * g + g * g);
+    }
+
+    void setCutoff (FastMath::Accuracy accuracy, float cutoffFrequency, float resonance) noexcept
+    {
+        switch (accuracy)
+        {
+            case FastMath::Accuracy::draft:   setCutoff<FastMath::Accuracy::draft>   (cutoffFrequency, resonance); break;
+            case FastMath::Accuracy::precise: setCutoff<FastMath::Accuracy::precise> (cutoffFrequency, resonance); break;
+            case FastMath::Accuracy::exact:   setCutoff<FastMath::Accuracy::exact>   (cutoffFrequency, resonance); break;
+        }
+    }
+
+    // Whether a lowpass with its cutoff at topCutoff (the top of the range)
+    // can be left out at this rate and resonance: its response has to stay
+    // within maxDeviation of flat all the way up to topCutoff. That's the
+    // threshold for "can't be heard" here, and the default resonance of 1
+    // passes it (its bump in the top octave peaks at about 1.25 dB), as does
+    // anything from about 0.85 to 1.04. Above topCutoff nothing counts: what
+    // skipping the filter leaves in there is out of hearing. Worked out from
+    // the filter's response; cheap, but not meant for every sample.
+    static constexpr float topCutoff = 20000.0f;
+    static constexpr double maxDeviation = 1.5;   // dB
+
+    static bool isTransparentAtTop (double sampleRate, float resonance) noexcept
+    {
+        if (topCutoff >= sampleRate * 0.5 || resonance <= 0.0f)
+            return false;
+
+        const auto gain = std::tan (3.141592653589793 * topCutoff / sampleRate);
+
+        for (double frequency = 250.0; frequency <= topCutoff; frequency += 250.0)
+        {
+            const auto z = std::polar (1.0, 2.0 * 3.141592653589793 * frequency / sampleRate);
+            const auto s = (z - 1.0) / ((z + 1.0) * gain);
+            const auto decibels = -20.0 * std::log10 (std::abs (s * s + s / (double) resonance + 1.0));
+
+            if (std::abs (decibels) > maxDeviation)
+                return false;
+        }
+
+        return true;
+    }
+
+    void setType (Type newType) noexcept   { type = newType; }
+    Type getType() const noexcept          { return type; }
+
+    SampleType processSample (SampleType input) noexcept
+    {
+        const auto highPass = (input - s1 * R2 - s1 * g - s2) * h;
+
+        const auto bandPass = highPass * g + s1;
+        s1 = highPass * g + bandPass;
+
+        const auto lowPass = bandPass * g + s2;
+        s2 = bandPass * g + lowPass;
+
+        switch (type)
+        {
+            case Type::bandPass: return bandPass;
+            case Type::highPass: return highPass;
+            case Type::lowPass:
+            default:             return lowPass;
+        }
+    }
+
+private:
+    Type type = Type::lowPass;
+    float piOverSampleRate = static_cast<float> (3.141592653589793 / 44100.0);
+
+    SampleType g  = SampleType (1);
+    SampleType R2 = SampleType (0.7071067811865476);
+    SampleType h  = SampleType (0.5);
+
+    SampleType s1 = SampleType (0);
+    SampleType s2 = SampleType (0);
+};
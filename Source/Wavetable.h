@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    Wavetable.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// A finished, band-limited wavetable: numFrames single cycles, each stored as
+// a chain of mip levels with fewer and fewer harmonics. Level 0 has every
+// harmonic below the frame's Nyquist, each following level has half as many,
+// down to a plain fundamental. Tables never shrink below minLevelSize samples,
+// so the linear interpolation stays clean on the top levels too.
+//
+// Once built it's never modified, so the audio thread can read it without
+// locking. WavetableLoader builds them and decides when they can be freed.
+class Wavetable
+{
+public:
+    static constexpr int minFrameSize = 32;
+    static constexpr int maxFrameSize = 8192;
+    static constexpr int maxFrames = 256;
+    static constexpr int minLevelSize = 256;
+
+    // frameSize has to be a power of two between minFrameSize and maxFrameSize
+    Wavetable (int numFramesToUse, int frameSizeToUse)
+        : numFrames (std::clamp (numFramesToUse, 1, maxFrames)),
+          frameSize (std::clamp (frameSizeToUse, minFrameSize, maxFrameSize))
+    {
+        size_t offset = 0;
+
+        for (int harmonics = frameSize / 2 - 1; ; harmonics /= 2)
+        {
+            Level level;
+            level.maxHarmonic = std::max (1, harmonics);
+            level.sizeBits = 0;
+
+            while ((1 << level.sizeBits) < std::max (minLevelSize, frameSize >> (int) levels.size()))
+                ++level.sizeBits;
+
+            level.offset = offset;
+            offset += (size_t) numFrames * (size_t) (level.getSize() + 1);
+            levels.push_back (level);
+
+            if (level.maxHarmonic == 1)
+                break;
+        }
+
+        samples.resize (offset, 0.0f);
+    }
+
+    int getNumFrames() const noexcept      { return numFrames; }
+    int getFrameSize() const noexcept      { return frameSize; }
+    int getNumLevels() const noexcept      { return (int) levels.size(); }
+
+    int getLevelSize (int level) const noexcept         { return levels[(size_t) level].getSize(); }
+    int getLevelSizeBits (int level) const noexcept     { return levels[(size_t) level].sizeBits; }
+    int getLevelMaxHarmonic (int level) const noexcept  { return levels[(size_t) level].maxHarmonic; }
+
+    // getLevelSize (level) + 1 samples; the last one repeats the first so the
+    // interpolation never has to wrap
+    const float* getFrame (int frame, int level) const noexcept
+    {
+        const auto& l = levels[(size_t) level];
+        return samples.data() + l.offset + (size_t) frame * (size_t) (l.getSize() + 1);
+    }
+
+    float* getFrame (int frame, int level) noexcept
+    {
+        return const_cast<float*> (static_cast<const Wavetable&> (*this).getFrame (frame, level));
+    }
+
+    // The first level whose top harmonic stays below Nyquist at this pitch
+    // (the increment is the 32-bit fixed-point phase step, 2^31 = Nyquist)
+    int getLevelForIncrement (uint32_t phaseIncrement) const noexcept
+    {
+        const auto nyquist = static_cast<uint64_t> (1) << 31;
+
+        for (size_t i = 0; i < levels.size(); ++i)
+            if (static_cast<uint64_t> (levels[i].maxHarmonic) * phaseIncrement < nyquist)
+                return (int) i;
+
+        return (int) levels.size() - 1;
+    }
+
+    size_t getMemoryUsage() const noexcept
+    {
+        return samples.size() * sizeof (float);
+    }
+
+private:
+    struct Level
+    {
+        int maxHarmonic;
+        int sizeBits;
+        size_t offset;
+
+        int getSize() const noexcept    { return 1 << sizeBits; }
+    };
+
+    int numFrames;
+    int frameSize;
+    std::vector<Level> levels;
+    std::vector<float> samples;
+};
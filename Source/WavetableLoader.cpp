@@ -0,0 +1,233 @@
+/*
+  ==============================================================================
+
+    WavetableLoader.cpp
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "WavetableLoader.h"
+
+WavetableLoader::WavetableLoader()
+{
+}
+
+WavetableLoader::~WavetableLoader()
+{
+}
+
+juce::Result WavetableLoader::loadFile (const juce::File& newFile)
+{
+    if (! newFile.existsAsFile())
+        return juce::Result::fail ("Can't find " + newFile.getFullPathName());
+
+    // Only the header is read here
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader (wavFormat.createMemoryMappedReader (newFile));
+
+    if (reader == nullptr)
+        return juce::Result::fail (newFile.getFileName() + " isn't a WAV file that can be mapped");
+
+    if (getFrameSizeForLength (reader->lengthInSamples) == 0)
+        return juce::Result::fail (newFile.getFileName() + " should be a single cycle of 32 to 8192 samples (a power of two), "
+                                   "or a sequence of " + juce::String (multiFrameSize) + "-sample frames");
+
+    // The same file saved again is a different table
+    const SharedTableCache::Key key { "wavetable",
+                                      newFile.getFullPathName() + ":" + juce::String (newFile.getSize())
+                                          + ":" + juce::String (newFile.getLastModificationTime().toMilliseconds()) };
+
+    auto entry = cache->getOrCreate<Wavetable> (key, [newFile] (const std::function<bool()>& shouldStop) -> std::unique_ptr<Wavetable>
+    {
+        juce::WavAudioFormat format;
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader (format.createMemoryMappedReader (newFile));
+
+        if (mappedReader == nullptr || ! mappedReader->mapEntireFile())
+            return nullptr;
+
+        return buildTable (*mappedReader, shouldStop);
+    });
+
+    const juce::ScopedLock sl (lock);
+    file = newFile;
+    setPending (entry);
+
+    return juce::Result::ok();
+}
+
+void WavetableLoader::unload()
+{
+    const juce::ScopedLock sl (lock);
+    file = juce::File();
+
+    freeRetiredTables();
+    retire (pendingEntry, pending);
+    retire (activeEntry, active);
+}
+
+juce::File WavetableLoader::getFile() const
+{
+    const juce::ScopedLock sl (lock);
+    return file;
+}
+
+bool WavetableLoader::isBuilding() const noexcept
+{
+    auto* entry = pending.load();
+    return entry != nullptr && ! entry->isFinished();
+}
+
+bool WavetableLoader::waitUntilReady (int timeoutMilliseconds) const
+{
+    SharedTableCache::EntryPtr entry;
+
+    {
+        const juce::ScopedLock sl (lock);
+        entry = pendingEntry;
+    }
+
+    return entry == nullptr || entry->waitUntilReady (timeoutMilliseconds);
+}
+
+const Wavetable* WavetableLoader::getTable() const noexcept
+{
+    if (auto* entry = pending.load (std::memory_order_acquire))
+        if (auto* table = entry->get<Wavetable>())
+            return table;
+
+    if (auto* entry = active.load (std::memory_order_acquire))
+        return entry->get<Wavetable>();
+
+    return nullptr;
+}
+
+int WavetableLoader::getFrameSizeForLength (juce::int64 lengthInSamples) noexcept
+{
+    if (lengthInSamples >= Wavetable::minFrameSize && lengthInSamples <= Wavetable::maxFrameSize
+         && juce::isPowerOfTwo (lengthInSamples))
+        return (int) lengthInSamples;
+
+    if (lengthInSamples > 0 && lengthInSamples % multiFrameSize == 0)
+        return multiFrameSize;
+
+    return 0;
+}
+
+std::unique_ptr<Wavetable> WavetableLoader::buildTable (juce::AudioFormatReader& reader,
+                                                        const std::function<bool()>& shouldStop)
+{
+    const int frameSize = getFrameSizeForLength (reader.lengthInSamples);
+
+    if (frameSize == 0)
+        return nullptr;
+
+    const int numFrames = (int) juce::jmin ((juce::int64) Wavetable::maxFrames, reader.lengthInSamples / frameSize);
+    auto table = std::make_unique<Wavetable> (numFrames, frameSize);
+
+    juce::dsp::FFT forward (juce::roundToInt (std::log2 (frameSize)));
+    std::vector<std::unique_ptr<juce::dsp::FFT>> inverse ((size_t) table->getNumLevels());
+
+    for (int level = 0; level < table->getNumLevels(); ++level)
+        inverse[(size_t) level] = std::make_unique<juce::dsp::FFT> (table->getLevelSizeBits (level));
+
+    juce::AudioBuffer<float> frameBuffer (2, frameSize);
+    std::vector<float> spectrum ((size_t) frameSize * 2);
+    std::vector<float> levelData;
+    float peak = 0.0f;
+
+    for (int frame = 0; frame < numFrames; ++frame)
+    {
+        if (shouldStop())
+            return nullptr;
+
+        // Straight out of the mapped file; a mono file is duplicated into both channels
+        reader.read (&frameBuffer, 0, frameSize, (juce::int64) frame * frameSize, true, true);
+
+        std::fill (spectrum.begin(), spectrum.end(), 0.0f);
+
+        for (int i = 0; i < frameSize; ++i)
+            spectrum[(size_t) i] = 0.5f * (frameBuffer.getSample (0, i) + frameBuffer.getSample (1, i));
+
+        forward.performRealOnlyForwardTransform (spectrum.data(), true);
+
+        for (int level = 0; level < table->getNumLevels(); ++level)
+        {
+            const int size = table->getLevelSize (level);
+            const int maxHarmonic = juce::jmin (table->getLevelMaxHarmonic (level), size / 2 - 1);
+
+            // The forward transform isn't normalised and the inverse divides by
+            // its own size, hence the size ratio. DC is left out.
+            const float scale = (float) size / (float) frameSize;
+            levelData.assign ((size_t) size * 2, 0.0f);
+
+            for (int h = 1; h <= maxHarmonic; ++h)
+            {
+                levelData[(size_t) h * 2]     = spectrum[(size_t) h * 2] * scale;
+                levelData[(size_t) h * 2 + 1] = spectrum[(size_t) h * 2 + 1] * scale;
+            }
+
+            inverse[(size_t) level]->performRealOnlyInverseTransform (levelData.data());
+
+            auto* dest = table->getFrame (frame, level);
+            std::copy (levelData.begin(), levelData.begin() + size, dest);
+            dest[size] = dest[0];
+
+            peak = juce::jmax (peak, juce::FloatVectorOperations::findMaximum (dest, size),
+                                     -juce::FloatVectorOperations::findMinimum (dest, size));
+        }
+    }
+
+    // Same loudness as the built-in shapes, whatever level the file was at
+    if (peak > 0.0f)
+    {
+        for (int frame = 0; frame < numFrames; ++frame)
+            for (int level = 0; level < table->getNumLevels(); ++level)
+                juce::FloatVectorOperations::multiply (table->getFrame (frame, level), 1.0f / peak, table->getLevelSize (level) + 1);
+    }
+
+    return table;
+}
+
+void WavetableLoader::setPending (SharedTableCache::EntryPtr entry)
+{
+    freeRetiredTables();
+
+    // A finished pending table has been playing already, so it becomes the
+    // active one; one that's still building is given up on
+    if (pendingEntry != nullptr && pendingEntry->isReady())
+    {
+        retire (activeEntry, active);
+        activeEntry = pendingEntry;
+        active.store (activeEntry.get(), std::memory_order_release);
+    }
+    else
+    {
+        retire (pendingEntry, pending);
+    }
+
+    pendingEntry = entry;
+    pending.store (pendingEntry.get(), std::memory_order_release);
+}
+
+void WavetableLoader::retire (SharedTableCache::EntryPtr& entry, std::atomic<const SharedTableCache::Entry*>& visibleEntry)
+{
+    if (entry == nullptr)
+        return;
+
+    visibleEntry.store (nullptr, std::memory_order_release);
+
+    // The audio thread may still be in a block that picked up this table,
+    // so it's only let go of once that block has finished
+    retired.push_back ({ entry, blocksFinished.load() });
+    entry = nullptr;
+}
+
+void WavetableLoader::freeRetiredTables()
+{
+    const auto now = blocksFinished.load();
+
+    retired.erase (std::remove_if (retired.begin(), retired.end(),
+                                   [now] (const RetiredTable& r) { return r.retiredAtBlock < now; }),
+                   retired.end());
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    WavetableLoader.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Wavetable.h"
+#include "SharedTableCache.h"
+
+// Loads user wavetables from WAV files.
+//
+// The file is memory-mapped (nothing is read up front, so loadFile returns
+// straight away) and the band-limited mip levels are built from the mapped
+// samples on a background thread. Tables live in the SharedTableCache, so
+// any number of instances using the same file share one copy.
+//
+// The previous table keeps playing until the new one is ready; the audio
+// thread just reads getTable() once per block and sees the switch atomically.
+//
+// File layout: either one single cycle whose length is a power of two (32 to
+// 8192 samples), or any number of 2048-sample frames back to back (the usual
+// layout of wavetable libraries). Stereo files are mixed down to mono.
+class WavetableLoader
+{
+public:
+    static constexpr int multiFrameSize = 2048;
+
+    WavetableLoader();
+    ~WavetableLoader();
+
+    // Message thread. Checks the file and asks the cache for its table.
+    juce::Result loadFile (const juce::File& file);
+    void unload();
+
+    juce::File getFile() const;
+    bool isBuilding() const noexcept;
+
+    // Blocks until the table being built is ready (or failed). For offline
+    // renders, where the table showing up half way would change the result.
+    bool waitUntilReady (int timeoutMilliseconds) const;
+
+    // Audio thread: the table to use for this block, or nullptr. Stays valid
+    // until audioBlockFinished() has been called.
+    const Wavetable* getTable() const noexcept;
+    void audioBlockFinished() noexcept    { blocksFinished.fetch_add (1, std::memory_order_acq_rel); }
+
+    // Frame size for a file of this many samples, or 0 if it can't be used
+    static int getFrameSizeForLength (juce::int64 lengthInSamples) noexcept;
+
+    // Builds the mip levels from the reader. Returns nullptr if shouldStop
+    // comes back true half way.
+    static std::unique_ptr<Wavetable> buildTable (juce::AudioFormatReader& reader,
+                                                  const std::function<bool()>& shouldStop);
+
+private:
+    void setPending (SharedTableCache::EntryPtr entry);
+    void retire (SharedTableCache::EntryPtr& entry, std::atomic<const SharedTableCache::Entry*>& visibleEntry);
+    void freeRetiredTables();
+
+    struct RetiredTable
+    {
+        SharedTableCache::EntryPtr entry;
+        juce::uint64 retiredAtBlock;
+    };
+
+    juce::SharedResourcePointer<SharedTableCache> cache;
+
+    juce::CriticalSection lock;
+    juce::File file;
+    SharedTableCache::EntryPtr activeEntry, pendingEntry;
+    std::vector<RetiredTable> retired;
+
+    // what the audio thread sees of activeEntry and pendingEntry
+    std::atomic<const SharedTableCache::Entry*> active { nullptr };
+    std::atomic<const SharedTableCache::Entry*> pending { nullptr };
+    std::atomic<juce::uint64> blocksFinished { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WavetableLoader)
+};
@@ -0,0 +1,565 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 18 Oct 2026
+
+    Command line tools for 1xOsc, see --help.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "RenderJob.h"
+#include "MathBenchmark.h"
+#include "ParameterSweep.h"
+#include "StressTest.h"
+#include "../../../Source/Tracer.h"
+#include "../../../Source/AudioThreadGuard.h"
+#include "../../../Source/KernelDispatch.h"
+
+namespace
+{
+    RenderJob::Settings getRenderSettings (const juce::ArgumentList& args)
+    {
+        RenderJob::Settings settings;
+
+        if (args.containsOption ("--rate"))
+            settings.sampleRate = args.getValueForOption ("--rate").getDoubleValue();
+
+        if (args.containsOption ("--block"))
+            settings.blockSize = args.getValueForOption ("--block").getIntValue();
+
+        if (args.containsOption ("--bits"))
+            settings.bitDepth = args.getValueForOption ("--bits").getIntValue();
+
+        if (args.containsOption ("--tail"))
+            settings.tailSeconds = args.getValueForOption ("--tail").getDoubleValue();
+
+        if (settings.sampleRate < 8000.0 || settings.sampleRate > 768000.0)
+            juce::ConsoleApplication::fail ("--rate should be between 8000 and 768000");
+
+        if (settings.blockSize < 1 || settings.blockSize > 65536)
+            juce::ConsoleApplication::fail ("--block should be between 1 and 65536");
+
+        if (settings.bitDepth != 16 && settings.bitDepth != 24 && settings.bitDepth != 32)
+            juce::ConsoleApplication::fail ("--bits should be 16, 24 or 32");
+
+        return settings;
+    }
+
+    // Everything that isn't an option, after the command itself
+    juce::StringArray getPositionalArguments (const juce::ArgumentList& args)
+    {
+        juce::StringArray result;
+
+        for (int i = 1; i < args.size(); ++i)
+            if (! args[i].isOption())
+                result.add (args[i].text);
+
+        return result;
+    }
+
+    int getNumThreads (const juce::ArgumentList& args)
+    {
+        const int numCpus = juce::SystemStats::getNumCpus();
+
+        if (! args.containsOption ("--jobs"))
+            return numCpus;
+
+        return juce::jlimit (1, 256, args.getValueForOption ("--jobs").getIntValue());
+    }
+
+    //==============================================================================
+    void runRender (const juce::ArgumentList& args)
+    {
+        const auto settings = getRenderSettings (args);
+        const auto stateFile = args.containsOption ("--state") ? args.getFileForOption ("--state") : juce::File();
+        const auto cacheFile = args.containsOption ("--cache") ? args.getFileForOption ("--cache") : juce::File();
+
+        // <midi> <wav> pairs, from the command line and/or a list file
+        juce::StringArray files = getPositionalArguments (args);
+
+        if (args.containsOption ("--list"))
+        {
+            juce::StringArray lines;
+            lines.addLines (args.getFileForOption ("--list").loadFileAsString());
+
+            for (auto& line : lines)
+            {
+                juce::StringArray tokens;
+                tokens.addTokens (line, "\t", "\"");
+                tokens.removeEmptyStrings();
+
+                if (tokens.size() >= 2 && ! line.trimStart().startsWithChar ('#'))
+                    files.addArray (tokens, 0, 2);
+            }
+        }
+
+        if (files.isEmpty() || files.size() % 2 != 0)
+            juce::ConsoleApplication::fail ("Expected pairs of <midi file> <wav file>");
+
+        // Processors are made (and the state loaded) here on the message thread,
+        // only the rendering itself runs on the worker threads
+        juce::OwnedArray<RenderJob> jobs;
+
+        for (int i = 0; i < files.size(); i += 2)
+        {
+            auto* job = jobs.add (new RenderJob (juce::File::getCurrentWorkingDirectory().getChildFile (files[i]),
+                                                 juce::File::getCurrentWorkingDirectory().getChildFile (files[i + 1]),
+                                                 stateFile, settings));
+
+            if (job->getLoadResult().failed())
+                juce::ConsoleApplication::fail (job->getLoadResult().getErrorMessage());
+
+            if (cacheFile != juce::File())
+                job->getProcessor().setRenderCache (true, cacheFile);
+
+            if (args.containsOption ("--midi-grid"))
+                job->getProcessor().setMidiSubBlockSize (args.getValueForOption ("--midi-grid").getIntValue());
+        }
+
+        const int numThreads = juce::jmin (getNumThreads (args), jobs.size());
+        std::vector<juce::Result> results ((size_t) jobs.size(), juce::Result::ok());
+        const auto traceFile = args.containsOption ("--trace") ? args.getFileForOption ("--trace") : juce::File();
+
+        if (traceFile != juce::File())
+            Tracer::start();
+
+        const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+        {
+            juce::ThreadPool pool (numThreads);
+
+            for (int i = 0; i < jobs.size(); ++i)
+            {
+                pool.addJob ([&jobs, &results, i]
+                {
+                    results[(size_t) i] = jobs[i]->run();
+                    return juce::ThreadPoolJob::jobHasFinished;
+                });
+            }
+
+            while (pool.getNumJobs() > 0)
+                juce::Thread::sleep (10);
+        }
+
+        const auto totalSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+        if (traceFile != juce::File())
+        {
+            Tracer::stop();
+            const auto traceResult = Tracer::writeChromeTrace (traceFile);
+
+            std::cout << (traceResult.wasOk() ? "Trace written to " + traceFile.getFullPathName()
+                                              : traceResult.getErrorMessage()) << std::endl;
+
+            if (Tracer::getNumUntracedThreads() > 0)
+                std::cout << Tracer::getNumUntracedThreads() << " thread(s) left out of the trace (it records 16 at most)" << std::endl;
+        }
+        double totalAudioSeconds = 0.0;
+        int numFailed = 0;
+        int numCacheHits = 0, numCacheMisses = 0;
+
+        for (int i = 0; i < jobs.size(); ++i)
+        {
+            auto& job = *jobs[i];
+
+            if (results[(size_t) i].failed())
+            {
+                std::cout << job.getMidiFile().getFileName() << ": " << results[(size_t) i].getErrorMessage() << std::endl;
+                ++numFailed;
+                continue;
+            }
+
+            totalAudioSeconds += job.getAudioSeconds();
+            numCacheHits += job.getProcessor().getRenderCache().getNumHits();
+            numCacheMisses += job.getProcessor().getRenderCache().getNumMisses();
+
+            std::cout << job.getMidiFile().getFileName() << " -> " << job.getOutputFile().getFileName() << ": "
+                      << juce::String (job.getAudioSeconds(), 2) << " s in " << juce::String (job.getRenderSeconds(), 3) << " s ("
+                      << juce::String (job.getRealtimeFactor(), 1) << "x real time)" << std::endl;
+        }
+
+        std::cout << jobs.size() - numFailed << " file(s), " << juce::String (totalAudioSeconds, 2) << " s of audio in "
+                  << juce::String (totalSeconds, 3) << " s on " << numThreads << " thread(s) ("
+                  << juce::String (totalSeconds > 0.0 ? totalAudioSeconds / totalSeconds : 0.0, 1) << "x real time overall)" << std::endl;
+
+        if (cacheFile != juce::File())
+            std::cout << "Render cache: " << numCacheHits << " note(s) replayed, " << numCacheMisses << " rendered" << std::endl;
+
+        if (numFailed > 0)
+            juce::ConsoleApplication::fail (juce::String (numFailed) + " render(s) failed");
+    }
+
+    //==============================================================================
+    void runSweep (const juce::ArgumentList& args)
+    {
+        const auto files = getPositionalArguments (args);
+
+        if (files.size() != 1)
+            juce::ConsoleApplication::fail ("Expected one sweep spec");
+
+        if (! args.containsOption ("--out"))
+            juce::ConsoleApplication::fail ("--out=<directory> is needed");
+
+        const auto renderSettings = getRenderSettings (args);
+
+        ParameterSweep::Settings settings;
+        settings.sampleRate = renderSettings.sampleRate;
+        settings.blockSize = renderSettings.blockSize;
+        settings.bitDepth = renderSettings.bitDepth;
+        settings.numWorkers = getNumThreads (args);
+
+        if (args.containsOption ("--format"))
+        {
+            const auto format = args.getValueForOption ("--format");
+
+            if (format == "f32")
+                settings.format = ParameterSweep::Format::rawFloat;
+            else if (format != "wav")
+                juce::ConsoleApplication::fail ("--format should be wav or f32");
+        }
+
+        ParameterSweep sweep (args.getFileForOption ("--out"), settings);
+        const auto loadResult = sweep.loadSpec (juce::File::getCurrentWorkingDirectory().getChildFile (files[0]));
+
+        if (loadResult.failed())
+            juce::ConsoleApplication::fail (loadResult.getErrorMessage());
+
+        std::cout << "Sweep: " << sweep.getNumRenders() << " render(s) on " << sweep.getNumWorkers() << " worker(s)" << std::endl;
+
+        const auto result = sweep.run();
+
+        std::cout << sweep.getNumRendered() << " render(s), " << juce::String (sweep.getAudioSeconds(), 2) << " s of audio in "
+                  << juce::String (sweep.getRenderSeconds(), 3) << " s (" << juce::String (sweep.getRendersPerSecond(), 1)
+                  << " renders/s, " << juce::String (sweep.getRenderSeconds() > 0.0 ? sweep.getAudioSeconds() / sweep.getRenderSeconds() : 0.0, 1)
+                  << "x real time)" << std::endl;
+
+        if (sweep.getNumDuplicates() > 0)
+            std::cout << "Warning: " << sweep.getNumDuplicates() << " render(s) came out the same as another grid point" << std::endl;
+
+        if (result.failed())
+            juce::ConsoleApplication::fail (result.getErrorMessage());
+    }
+
+    //==============================================================================
+    StressTest::Settings getStressSettings (const juce::ArgumentList& args)
+    {
+        StressTest::Settings settings;
+
+        if (args.containsOption ("--rate"))
+            settings.sampleRate = args.getValueForOption ("--rate").getDoubleValue();
+
+        if (args.containsOption ("--blocks"))
+        {
+            settings.blockSizes.clear();
+
+            for (auto& size : juce::StringArray::fromTokens (args.getValueForOption ("--blocks"), ",", {}))
+                settings.blockSizes.add (size.trim().getIntValue());
+        }
+
+        if (args.containsOption ("--seconds"))
+            settings.secondsPerBlockSize = args.getValueForOption ("--seconds").getDoubleValue();
+
+        if (args.containsOption ("--seed"))
+            settings.seed = args.getValueForOption ("--seed").getLargeIntValue();
+
+        if (args.containsOption ("--prepare-every"))
+            settings.prepareEvery = args.getValueForOption ("--prepare-every").getIntValue();
+
+        if (args.containsOption ("--notes"))
+            settings.maxNotesPerBurst = args.getValueForOption ("--notes").getIntValue();
+
+        if (args.containsOption ("--events"))
+            settings.eventsPerBlock = args.getValueForOption ("--events").getIntValue();
+
+        if (settings.sampleRate < 8000.0 || settings.sampleRate > 768000.0)
+            juce::ConsoleApplication::fail ("--rate should be between 8000 and 768000");
+
+        if (settings.blockSizes.isEmpty())
+            juce::ConsoleApplication::fail ("--blocks needs at least one block size");
+
+        for (auto size : settings.blockSizes)
+            if (size < 1 || size > 65536)
+                juce::ConsoleApplication::fail ("Block sizes should be between 1 and 65536");
+
+        if (settings.secondsPerBlockSize <= 0.0)
+            juce::ConsoleApplication::fail ("--seconds should be more than 0");
+
+        // the plugin's MIDI coalescer leaves blocks denser than 4096 events alone
+        if (settings.eventsPerBlock < 0 || settings.eventsPerBlock > 4000)
+            juce::ConsoleApplication::fail ("--events should be between 0 and 4000");
+
+        return settings;
+    }
+
+    // A limit on a percentile, in percent of the block's real-time budget
+    struct StressLimit
+    {
+        const char* option;
+        const char* label;
+        double StressTest::Result::* value;
+    };
+
+    void runStress (const juce::ArgumentList& args)
+    {
+        StressTest test (getStressSettings (args));
+
+        if (args.containsOption ("--state"))
+        {
+            const auto stateResult = RenderJob::loadState (test.getProcessor(), args.getFileForOption ("--state"));
+
+            if (stateResult.failed())
+                juce::ConsoleApplication::fail (stateResult.getErrorMessage());
+        }
+
+        const auto& settings = test.getSettings();
+        const auto midiGrid = args.containsOption ("--midi-grid") ? args.getValueForOption ("--midi-grid").getIntValue() : 1;
+        const auto compareGrid = args.containsOption ("--compare-grid");
+
+        if (compareGrid && midiGrid <= 1)
+            juce::ConsoleApplication::fail ("--compare-grid needs a --midi-grid of 2 or more");
+
+        std::cout << "Stress test at " << settings.sampleRate << " Hz, " << settings.secondsPerBlockSize
+                  << " s of audio per block size, seed " << settings.seed;
+
+        if (settings.eventsPerBlock > 0)
+            std::cout << ", " << settings.eventsPerBlock << " extra MIDI events per block";
+
+        std::cout << std::endl;
+        std::cout << "Kernels: " << KernelDispatch::getName (KernelDispatch::get().instructionSet) << std::endl;
+
+        auto column = [] (double milliseconds, double percent)
+        {
+            return (juce::String (milliseconds, 3) + " (" + juce::String (percent, 1) + "%)").paddedLeft (' ', 18);
+        };
+
+        auto runWithGrid = [&] (int grid)
+        {
+            test.getProcessor().setMidiSubBlockSize (grid);
+            const auto results = test.run();
+
+            std::cout << "\nMIDI grid " << (grid > 1 ? juce::String (grid) + " samples" : juce::String ("off")) << std::endl;
+            std::cout << "block  budget ms" << juce::String ("p50 ms").paddedLeft (' ', 18) << juce::String ("p99 ms").paddedLeft (' ', 18)
+                      << juce::String ("p99.9 ms").paddedLeft (' ', 18) << juce::String ("max ms").paddedLeft (' ', 18)
+                      << "  overruns  prepare ms  events/block" << std::endl;
+
+            for (const auto& r : results)
+            {
+                std::cout << juce::String (r.blockSize).paddedLeft (' ', 5) << juce::String (r.budget, 3).paddedLeft (' ', 11)
+                          << column (r.p50, r.getPercentOfBudget (r.p50))
+                          << column (r.p99, r.getPercentOfBudget (r.p99))
+                          << column (r.p999, r.getPercentOfBudget (r.p999))
+                          << column (r.max, r.getPercentOfBudget (r.max))
+                          << juce::String (r.numOverruns).paddedLeft (' ', 10)
+                          << juce::String (r.maxPrepare, 1).paddedLeft (' ', 12)
+                          << juce::String ((double) r.numMidiEvents / juce::jmax (1, r.numBlocks), 1).paddedLeft (' ', 14) << std::endl;
+            }
+
+            return results;
+        };
+
+        // The same storm without the grid first, then with it
+        const auto ungriddedResults = compareGrid ? runWithGrid (1) : juce::Array<StressTest::Result>();
+        const auto results = runWithGrid (midiGrid);
+
+        if (compareGrid)
+        {
+            std::cout << "\nWith the grid, in percent of the times without it" << std::endl;
+
+            for (int i = 0; i < results.size(); ++i)
+            {
+                const auto& without = ungriddedResults.getReference (i);
+                const auto& with = results.getReference (i);
+
+                auto ratio = [] (double a, double b) { return juce::String (b > 0.0 ? 100.0 * a / b : 0.0, 1) + "%"; };
+
+                std::cout << juce::String (with.blockSize).paddedLeft (' ', 5)
+                          << "  mean " << ratio (with.mean, without.mean)
+                          << "  p50 " << ratio (with.p50, without.p50)
+                          << "  p99 " << ratio (with.p99, without.p99)
+                          << "  max " << ratio (with.max, without.max) << std::endl;
+            }
+        }
+
+        if (args.containsOption ("--json"))
+        {
+            const auto jsonFile = args.getFileForOption ("--json");
+            auto json = StressTest::toJson (settings, results);
+            json.getDynamicObject()->setProperty ("midiGrid", midiGrid);
+
+            if (compareGrid)
+                json.getDynamicObject()->setProperty ("withoutGrid", StressTest::toJson (settings, ungriddedResults)["results"]);
+
+            if (! jsonFile.replaceWithText (juce::JSON::toString (json)))
+                juce::ConsoleApplication::fail ("Can't write to " + jsonFile.getFullPathName());
+        }
+
+        // CI thresholds, in percent of the budget
+        static const StressLimit limits[] =
+        {
+            { "--max-p50",  "p50",   &StressTest::Result::p50 },
+            { "--max-p99",  "p99",   &StressTest::Result::p99 },
+            { "--max-p999", "p99.9", &StressTest::Result::p999 },
+            { "--max-peak", "max",   &StressTest::Result::max }
+        };
+
+        juce::StringArray failures;
+
+        for (const auto& limit : limits)
+        {
+            if (! args.containsOption (limit.option))
+                continue;
+
+            const auto maxPercent = args.getValueForOption (limit.option).getDoubleValue();
+
+            for (const auto& r : results)
+            {
+                const auto percent = r.getPercentOfBudget (r.*limit.value);
+
+                if (percent > maxPercent)
+                    failures.add ("block " + juce::String (r.blockSize) + ": " + limit.label + " is " + juce::String (percent, 1)
+                                  + "% of the budget (limit " + juce::String (maxPercent, 1) + "%)");
+            }
+        }
+
+       #if ONEXOSC_AUDIO_THREAD_GUARD
+        for (const auto& r : results)
+            if (r.numGuardViolations > 0)
+                failures.add ("block " + juce::String (r.blockSize) + ": " + juce::String (r.numGuardViolations)
+                              + " real-time safety violation(s) on the audio thread");
+
+        if (AudioThreadGuard::getNumViolations() > 0)
+            std::cout << AudioThreadGuard::getReport() << std::endl;
+       #endif
+
+        if (! failures.isEmpty())
+            juce::ConsoleApplication::fail (failures.joinIntoString ("\n"));
+    }
+
+    //==============================================================================
+    void runBench (const juce::ArgumentList& args)
+    {
+        MathBenchmark::Settings settings;
+
+        if (args.containsOption ("--block"))
+            settings.blockSize = args.getValueForOption ("--block").getIntValue();
+
+        if (args.containsOption ("--seconds"))
+            settings.secondsPerCase = args.getValueForOption ("--seconds").getDoubleValue();
+
+        std::cout << "FastMath against the standard library, blocks of " << settings.blockSize << " values" << std::endl;
+        std::cout << juce::String ("function").paddedRight (' ', 10) << juce::String ("tier").paddedRight (' ', 9)
+                  << juce::String ("ns/value").paddedLeft (' ', 10) << juce::String ("vs std").paddedLeft (' ', 10)
+                  << "  max error" << std::endl;
+
+        const auto results = MathBenchmark::run (settings);
+        double stdNanoseconds = 0.0;
+
+        for (const auto& r : results)
+        {
+            if (r.variant == "std")
+                stdNanoseconds = r.nanosecondsPerValue;
+
+            const auto speedUp = r.nanosecondsPerValue > 0.0 ? stdNanoseconds / r.nanosecondsPerValue : 0.0;
+
+            std::cout << r.function.paddedRight (' ', 10) << r.variant.paddedRight (' ', 9)
+                      << juce::String (r.nanosecondsPerValue, 3).paddedLeft (' ', 10)
+                      << (juce::String (speedUp, 1) + "x").paddedLeft (' ', 10)
+                      << "  " << juce::String (r.maxError, 2, true) << (r.relativeError ? " rel" : "") << std::endl;
+        }
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // The processors need a message manager (for their parameter timers etc.)
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+
+    app.addHelpCommand ("--help|-h", "Usage:", true);
+
+    app.addCommand ({ "render",
+                      "render [options] <midi> <wav> [<midi> <wav> ...]",
+                      "Renders Standard MIDI Files to WAV through the synth, faster than real time.",
+                      "Each pair is rendered by its own instance of the synth; the pairs are spread\n"
+                      "over the CPU cores. The output matches an offline bounce in a host at the\n"
+                      "same sample rate and block size, sample for sample.\n\n"
+                      "  --state=<file>   plugin state (as saved by a host) or an .xml preset\n"
+                      "  --list=<file>    more pairs, one per line: <midi><tab><wav>\n"
+                      "  --rate=<hz>      sample rate, default 48000\n"
+                      "  --block=<n>      block size, default 512\n"
+                      "  --bits=<n>       16, 24 or 32 (float), default 24\n"
+                      "  --tail=<s>       seconds rendered after the last event, default 2\n"
+                      "  --jobs=<n>       renders running at once, default one per core\n"
+                      "  --midi-grid=<n>  moves MIDI events onto an n-sample grid, default 1 (off)\n"
+                      "  --cache=<file>   replays the start of notes rendered before (by this run or an\n"
+                      "                   earlier one) from a render cache kept in the file; within\n"
+                      "                   float rounding of a full render. Each render has its own\n"
+                      "                   cache and merges what it recorded into the file when it\n"
+                      "                   finishes (renders running at once don't share notes)\n"
+                      "  --trace=<file>   records a timeline of the renders (Chrome / Perfetto JSON);\n"
+                      "                   each render thread keeps its last 16384 events",
+                      runRender });
+
+    app.addCommand ({ "sweep",
+                      "sweep [options] --out=<directory> <spec.json>",
+                      "Renders the synth over a grid of parameter values, one file per point.",
+                      "Every combination of the values in the spec is rendered offline into its own\n"
+                      "file in the output directory, and manifest.csv lists the values of each.\n"
+                      "The renders are spread over a set of workers with one synth each, prepared\n"
+                      "once and reset between renders; a render is the same whichever worker did it.\n\n"
+                      "The spec is a JSON object:\n"
+                      "  \"state\"       a plugin state or .xml preset the sweep starts from (optional)\n"
+                      "  \"notes\"       [ { \"note\": 60, \"velocity\": 0.8, \"start\": 0, \"length\": 1 } ]\n"
+                      "  \"tail\"        seconds rendered after the last note ends, default 1\n"
+                      "  \"parameters\"  { \"<parameter ID>\": [ values ] or { \"from\", \"to\", \"steps\" }\n"
+                      "                or one value, ... }; the last one changes fastest\n\n"
+                      "  --out=<dir>      where the files and the manifest go\n"
+                      "  --format=<f>     wav, or f32 for headerless interleaved 32-bit float; default wav\n"
+                      "  --rate=<hz>      sample rate, default 48000\n"
+                      "  --block=<n>      block size, default 512\n"
+                      "  --bits=<n>       WAV bit depth, 16, 24 or 32 (float), default 24\n"
+                      "  --jobs=<n>       workers, default one per core",
+                      runSweep });
+
+    app.addCommand ({ "stress",
+                      "stress [options]",
+                      "Measures worst-case block times under a storm of MIDI and automation.",
+                      "Drives the synth in real-time mode with seeded random note bursts, pitch bend,\n"
+                      "controllers, automation of every parameter, waveform switches and regular\n"
+                      "prepareToPlay cycles, and prints the block time distribution against the\n"
+                      "real-time budget (block size / sample rate) for each block size.\n\n"
+                      "  --state=<file>         plugin state (as saved by a host) or an .xml preset\n"
+                      "  --rate=<hz>            sample rate, default 48000\n"
+                      "  --blocks=<n,n,...>     block sizes, default 64,128,256,512\n"
+                      "  --seconds=<s>          audio rendered per block size, default 30\n"
+                      "  --seed=<n>             the storm is the same for the same seed, default 1\n"
+                      "  --prepare-every=<n>    blocks between prepareToPlay cycles, default 4000 (0 = never)\n"
+                      "  --notes=<n>            most notes started at once, default 16\n"
+                      "  --events=<n>           n more MIDI events in every block (controllers, pitch bend,\n"
+                      "                         pressure, short notes), as a MIDI effect sends, up to 4000\n"
+                      "  --midi-grid=<n>        moves MIDI events onto an n-sample grid, default 1 (off)\n"
+                      "  --compare-grid         runs it all without the grid too, and compares the two\n"
+                      "  --json=<file>          also writes the results as JSON\n\n"
+                      "Limits for CI, in percent of the budget; exceeding one fails the command:\n"
+                      "  --max-p50=<%>  --max-p99=<%>  --max-p999=<%>  --max-peak=<%>\n\n"
+                      "Built with ONEXOSC_AUDIO_THREAD_GUARD=1 it also fails on any allocation, lock\n"
+                      "or blocking call inside processBlock, and lists them.",
+                      runStress });
+
+    app.addCommand ({ "bench",
+                      "bench [options]",
+                      "Times FastMath's sin2pi, tan and exp2 against the standard library.",
+                      "Runs the block versions the voices use over the ranges the synth uses them\n"
+                      "for, in each accuracy tier, next to the float standard library functions,\n"
+                      "and prints the time per value and the largest error against double precision.\n\n"
+                      "  --block=<n>      values per call, default 4096\n"
+                      "  --seconds=<s>    time spent on each function and tier, default 0.25",
+                      runBench });
+
+    return app.findAndRunCommand (argc, argv);
+}
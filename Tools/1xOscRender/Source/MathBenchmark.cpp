@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+
+    MathBenchmark.cpp
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "MathBenchmark.h"
+#include "../../../Source/FastMath.h"
+
+namespace
+{
+    using Accuracy = FastMath::Accuracy;
+    using BlockFunction = void (*) (const float*, float*, int);
+
+    struct Function
+    {
+        const char* name;
+        float start, end;                 // the inputs are spread over this range
+        bool relativeError;
+        double (*reference) (double);
+        BlockFunction std;
+        BlockFunction draft, precise, exact;
+    };
+
+    // What the voices did before FastMath: the float standard library
+    void stdSin2pi (const float* src, float* dest, int numValues)
+    {
+        for (int i = 0; i < numValues; ++i)
+            dest[i] = std::sin (6.2831853f * src[i]);
+    }
+
+    void stdTan (const float* src, float* dest, int numValues)
+    {
+        for (int i = 0; i < numValues; ++i)
+            dest[i] = std::tan (src[i]);
+    }
+
+    void stdExp2 (const float* src, float* dest, int numValues)
+    {
+        for (int i = 0; i < numValues; ++i)
+            dest[i] = std::exp2 (src[i]);
+    }
+
+    const Function functions[] =
+    {
+        { "sin2pi", -4.0f, 4.0f, false,
+          [] (double x) { return std::sin (6.283185307179586 * x); },
+          stdSin2pi, FastMath::sin2pi<Accuracy::draft>, FastMath::sin2pi<Accuracy::precise>, FastMath::sin2pi<Accuracy::exact> },
+
+        // the filter's prewarp, up to fs / 2.04
+        { "tan", 0.0f, 0.49f * juce::MathConstants<float>::pi, true,
+          [] (double x) { return std::tan (x); },
+          stdTan, FastMath::tan<Accuracy::draft>, FastMath::tan<Accuracy::precise>, FastMath::tan<Accuracy::exact> },
+
+        { "exp2", -10.0f, 10.0f, true,
+          [] (double x) { return std::exp2 (x); },
+          stdExp2, FastMath::exp2<Accuracy::draft>, FastMath::exp2<Accuracy::precise>, FastMath::exp2<Accuracy::exact> }
+    };
+
+    // Keeps the compiler from dropping the work
+    volatile float sink = 0.0f;
+
+    double timeFunction (BlockFunction function, const std::vector<float>& inputs, std::vector<float>& outputs,
+                         double secondsPerCase)
+    {
+        const auto numValues = (int) inputs.size();
+        const auto ticksPerSecond = (double) juce::Time::getHighResolutionTicksPerSecond();
+
+        // warm up the caches
+        function (inputs.data(), outputs.data(), numValues);
+
+        juce::int64 numCalls = 0;
+        const auto start = juce::Time::getHighResolutionTicks();
+        auto elapsed = (juce::int64) 0;
+
+        while ((double) elapsed < secondsPerCase * ticksPerSecond)
+        {
+            for (int i = 0; i < 16; ++i)
+                function (inputs.data(), outputs.data(), numValues);
+
+            sink = sink + outputs[(size_t) (numCalls % numValues)];
+            numCalls += 16;
+            elapsed = juce::Time::getHighResolutionTicks() - start;
+        }
+
+        return 1.0e9 * ((double) elapsed / ticksPerSecond) / ((double) numCalls * numValues);
+    }
+}
+
+juce::Array<MathBenchmark::Result> MathBenchmark::run (const Settings& settings)
+{
+    juce::Array<Result> results;
+    const auto blockSize = juce::jmax (16, settings.blockSize);
+
+    std::vector<float> inputs ((size_t) blockSize), outputs ((size_t) blockSize);
+
+    for (const auto& function : functions)
+    {
+        for (int i = 0; i < blockSize; ++i)
+            inputs[(size_t) i] = function.start + (function.end - function.start) * (float) i / (float) (blockSize - 1);
+
+        const std::pair<const char*, BlockFunction> variants[] =
+        {
+            { "std", function.std },
+            { "draft", function.draft },
+            { "precise", function.precise },
+            { "exact", function.exact }
+        };
+
+        for (const auto& [variant, blockFunction] : variants)
+        {
+            Result result;
+            result.function = function.name;
+            result.variant = variant;
+            result.relativeError = function.relativeError;
+            result.nanosecondsPerValue = timeFunction (blockFunction, inputs, outputs, settings.secondsPerCase);
+
+            blockFunction (inputs.data(), outputs.data(), blockSize);
+
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const auto expected = function.reference ((double) inputs[(size_t) i]);
+                auto error = std::abs ((double) outputs[(size_t) i] - expected);
+
+                if (function.relativeError && expected != 0.0)
+                    error /= std::abs (expected);
+
+                result.maxError = juce::jmax (result.maxError, error);
+            }
+
+            results.add (result);
+        }
+    }
+
+    return results;
+}
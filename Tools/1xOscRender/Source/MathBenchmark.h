@@ -0,0 +1,41 @@
+/*
+  ==============================================================================
+
+    MathBenchmark.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Micro-benchmarks of FastMath (see FastMath.h) against the standard library.
+//
+// Each function runs over a block of inputs spread across the range the synth
+// uses it for, with the block versions the voices call: std (the float
+// standard library function, what the code used before FastMath), then the
+// draft, precise and exact tiers. For each one it reports the time per value
+// and the largest error against the double-precision standard library, so
+// the numbers in FastMath.h can be checked on any machine.
+class MathBenchmark
+{
+public:
+    struct Settings
+    {
+        int blockSize = 4096;
+        double secondsPerCase = 0.25;
+    };
+
+    struct Result
+    {
+        juce::String function;
+        juce::String variant;
+        double nanosecondsPerValue = 0.0;
+        double maxError = 0.0;
+        bool relativeError = false;
+    };
+
+    static juce::Array<Result> run (const Settings& settings);
+};
@@ -0,0 +1,458 @@
+/*
+  ==============================================================================
+
+    ParameterSweep.cpp
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "ParameterSweep.h"
+#include "RenderJob.h"
+
+namespace
+{
+    // A value from the spec: a number, or the name of one of a choice's options
+    juce::Result parseValue (const juce::var& value, const juce::RangedAudioParameter& parameter,
+                             float& result, juce::String& label)
+    {
+        if (value.isString())
+        {
+            const auto* choice = dynamic_cast<const juce::AudioParameterChoice*> (&parameter);
+            const auto index = choice != nullptr ? choice->choices.indexOf (value.toString(), true) : -1;
+
+            if (index < 0)
+                return juce::Result::fail (parameter.paramID + ": \"" + value.toString() + "\" isn't one of its values");
+
+            result = (float) index;
+            label = choice->choices[index];
+            return juce::Result::ok();
+        }
+
+        if (! (value.isInt() || value.isInt64() || value.isDouble() || value.isBool()))
+            return juce::Result::fail (parameter.paramID + ": expected a number, a name, a list or { \"from\", \"to\", \"steps\" }");
+
+        result = (float) (double) value;
+
+        const auto& range = parameter.getNormalisableRange();
+
+        if (result < range.start || result > range.end)
+            return juce::Result::fail (parameter.paramID + ": " + juce::String (result) + " is outside "
+                                       + juce::String (range.start) + " to " + juce::String (range.end));
+
+        if (const auto* choice = dynamic_cast<const juce::AudioParameterChoice*> (&parameter))
+            label = choice->choices[juce::roundToInt (result)];
+        else
+            label = juce::String (result);
+
+        return juce::Result::ok();
+    }
+}
+
+ParameterSweep::ParameterSweep (const juce::File& directory, const Settings& sweepSettings)
+    : outputDirectory (directory), settings (sweepSettings)
+{
+    // Processors are made here on the message thread, like RenderJob's
+    for (int i = 0; i < juce::jmax (1, settings.numWorkers); ++i)
+        workers.add (new Worker())->processor = std::make_unique<_1xOscAudioProcessor>();
+
+    notes.add (Note());
+}
+
+ParameterSweep::~ParameterSweep()
+{
+}
+
+//==============================================================================
+juce::Result ParameterSweep::loadSpec (const juce::File& specFile)
+{
+    juce::var spec;
+    const auto parseResult = juce::JSON::parse (specFile.loadFileAsString(), spec);
+
+    if (parseResult.failed())
+        return juce::Result::fail (specFile.getFileName() + ": " + parseResult.getErrorMessage());
+
+    if (! spec.isObject())
+        return juce::Result::fail (specFile.getFileName() + ": expected a JSON object");
+
+    // The base patch, in every worker's processor
+    if (spec.hasProperty ("state"))
+    {
+        const auto stateFile = specFile.getParentDirectory().getChildFile (spec["state"].toString());
+
+        for (auto* worker : workers)
+        {
+            const auto stateResult = RenderJob::loadState (*worker->processor, stateFile);
+
+            if (stateResult.failed())
+                return stateResult;
+        }
+    }
+
+    if (spec.hasProperty ("notes"))
+    {
+        const auto* noteList = spec["notes"].getArray();
+
+        if (noteList == nullptr || noteList->isEmpty())
+            return juce::Result::fail ("\"notes\" should be a list of at least one note");
+
+        notes.clearQuick();
+
+        for (const auto& item : *noteList)
+        {
+            Note note;
+            note.noteNumber = juce::jlimit (0, 127, (int) item.getProperty ("note", note.noteNumber));
+            note.velocity = juce::jlimit (0.0f, 1.0f, (float) item.getProperty ("velocity", note.velocity));
+            note.start = juce::jmax (0.0, (double) item.getProperty ("start", note.start));
+            note.length = juce::jmax (0.0, (double) item.getProperty ("length", note.length));
+            notes.add (note);
+        }
+    }
+
+    tailSeconds = juce::jmax (0.0, (double) spec.getProperty ("tail", tailSeconds));
+
+    // The grid
+    axes.clearQuick();
+
+    if (auto* parameters = spec["parameters"].getDynamicObject())
+    {
+        auto& apvts = workers.getFirst()->processor->apvts;
+
+        for (const auto& property : parameters->getProperties())
+        {
+            const auto id = property.name.toString();
+            auto* parameter = apvts.getParameter (id);
+
+            if (parameter == nullptr)
+                return juce::Result::fail ("There's no parameter called \"" + id + "\"");
+
+            Axis axis;
+            axis.parameterID = id;
+
+            auto addValue = [&] (const juce::var& value)
+            {
+                float result = 0.0f;
+                juce::String label;
+                const auto valueResult = parseValue (value, *parameter, result, label);
+
+                if (valueResult.wasOk())
+                {
+                    axis.values.add (result);
+                    axis.labels.add (label);
+                }
+
+                return valueResult;
+            };
+
+            juce::Result result = juce::Result::ok();
+
+            if (const auto* list = property.value.getArray())
+            {
+                for (const auto& value : *list)
+                    if (result.wasOk())
+                        result = addValue (value);
+            }
+            else if (property.value.hasProperty ("steps"))
+            {
+                const auto from = (double) property.value["from"];
+                const auto to = (double) property.value["to"];
+                const auto steps = (int) property.value["steps"];
+
+                if (steps < 1)
+                    return juce::Result::fail (id + ": \"steps\" should be 1 or more");
+
+                for (int i = 0; i < steps && result.wasOk(); ++i)
+                    result = addValue (steps > 1 ? from + (to - from) * i / (steps - 1) : from);
+            }
+            else
+            {
+                result = addValue (property.value);
+            }
+
+            if (result.failed())
+                return result;
+
+            if (axis.values.isEmpty())
+                return juce::Result::fail (id + ": no values");
+
+            axes.add (axis);
+        }
+    }
+
+    juce::int64 numRenders = 1;
+
+    for (const auto& axis : axes)
+    {
+        numRenders *= axis.values.size();
+
+        if (numRenders > std::numeric_limits<int>::max())
+            return juce::Result::fail ("That's too many renders for one sweep");
+    }
+
+    // The notes as MIDI, note offs first where one ends as the next starts
+    events.clear();
+    double endTime = 0.0;
+
+    for (const auto& note : notes)
+    {
+        const auto startSample = (juce::int64) std::llround (note.start * settings.sampleRate);
+        const auto endSample = (juce::int64) std::llround ((note.start + note.length) * settings.sampleRate);
+        events.push_back ({ startSample, juce::MidiMessage::noteOn (1, note.noteNumber, note.velocity) });
+        events.push_back ({ endSample, juce::MidiMessage::noteOff (1, note.noteNumber) });
+        endTime = juce::jmax (endTime, note.start + note.length);
+    }
+
+    std::stable_sort (events.begin(), events.end(), [] (const auto& a, const auto& b)
+    {
+        return a.first < b.first || (a.first == b.first && a.second.isNoteOff() && ! b.second.isNoteOff());
+    });
+
+    numSamplesPerRender = juce::jmax ((juce::int64) 1, (juce::int64) std::ceil ((endTime + tailSeconds) * settings.sampleRate));
+    return juce::Result::ok();
+}
+
+int ParameterSweep::getNumRenders() const noexcept
+{
+    int numRenders = 1;
+
+    for (const auto& axis : axes)
+        numRenders *= axis.values.size();
+
+    return numRenders;
+}
+
+int ParameterSweep::getValueIndex (int renderIndex, int axisIndex) const noexcept
+{
+    // the last axis changes fastest
+    int stride = 1;
+
+    for (int i = axisIndex + 1; i < axes.size(); ++i)
+        stride *= axes.getReference (i).values.size();
+
+    return (renderIndex / stride) % axes.getReference (axisIndex).values.size();
+}
+
+juce::File ParameterSweep::getOutputFile (int index) const
+{
+    const auto numDigits = juce::String (juce::jmax (0, getNumRenders() - 1)).length();
+    return outputDirectory.getChildFile (juce::String (index).paddedLeft ('0', numDigits)
+                                         + (settings.format == Format::wav ? ".wav" : ".f32"));
+}
+
+//==============================================================================
+juce::Result ParameterSweep::run()
+{
+    const auto directoryResult = outputDirectory.createDirectory();
+
+    if (directoryResult.failed())
+        return directoryResult;
+
+    const int numRenders = getNumRenders();
+    std::vector<juce::Result> results ((size_t) numRenders, juce::Result::ok());
+    std::vector<juce::uint64> audioHashes ((size_t) numRenders);
+    std::atomic<int> nextIndex { 0 };
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    {
+        const int numWorkers = juce::jmin (workers.size(), numRenders);
+        juce::ThreadPool pool (juce::jmax (1, numWorkers));
+
+        // Each worker takes the next render as soon as it's done with one
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            auto* worker = workers[i];
+
+            pool.addJob ([this, worker, numRenders, &results, &audioHashes, &nextIndex]
+            {
+                prepare (*worker);
+
+                for (int index = nextIndex++; index < numRenders; index = nextIndex++)
+                    results[(size_t) index] = render (*worker, index, audioHashes[(size_t) index]);
+
+                worker->processor->releaseResources();
+                return juce::ThreadPoolJob::jobHasFinished;
+            });
+        }
+
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep (10);
+    }
+
+    renderSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+    std::vector<bool> rendered ((size_t) numRenders);
+    juce::StringArray errors;
+
+    for (int i = 0; i < numRenders; ++i)
+    {
+        rendered[(size_t) i] = results[(size_t) i].wasOk();
+
+        if (! rendered[(size_t) i])
+            errors.add (getOutputFile (i).getFileName() + ": " + results[(size_t) i].getErrorMessage());
+    }
+
+    numRendered = numRenders - errors.size();
+
+    // Grid points that sound the same as an earlier one
+    std::unordered_set<juce::uint64> distinctAudio;
+    numDuplicates = 0;
+
+    for (int i = 0; i < numRenders; ++i)
+        if (rendered[(size_t) i] && ! distinctAudio.insert (audioHashes[(size_t) i]).second)
+            ++numDuplicates;
+
+    if (numRendered > 1 && distinctAudio.size() == 1)
+        errors.add ("Every grid point rendered the same audio: the swept parameters aren't reaching the synth");
+
+    audioSeconds = (double) numRendered * (double) numSamplesPerRender / settings.sampleRate;
+
+    const auto manifestResult = writeManifest (rendered);
+
+    if (manifestResult.failed())
+        errors.add (manifestResult.getErrorMessage());
+
+    return errors.isEmpty() ? juce::Result::ok() : juce::Result::fail (errors.joinIntoString ("\n"));
+}
+
+void ParameterSweep::prepare (Worker& worker) const
+{
+    // What a host does before an offline bounce, once per worker
+    auto& p = *worker.processor;
+    p.setNonRealtime (true);
+    p.setRateAndBufferSizeDetails (settings.sampleRate, settings.blockSize);
+    p.prepareToPlay (settings.sampleRate, settings.blockSize);
+
+    worker.buffer.setSize (juce::jmax (p.getTotalNumInputChannels(), p.getTotalNumOutputChannels()), settings.blockSize);
+    worker.midi.ensureSize (events.size() * 16);
+}
+
+juce::Result ParameterSweep::render (Worker& worker, int index, juce::uint64& audioHash) const
+{
+    auto& p = *worker.processor;
+
+    // This point of the grid, then back to a clean start
+    for (int i = 0; i < axes.size(); ++i)
+    {
+        const auto& axis = axes.getReference (i);
+
+        if (auto* parameter = p.apvts.getParameter (axis.parameterID))
+        {
+            // as a host sets it; the listener call is what updates the value
+            // the processor reads (getRawParameterValue)
+            const auto value = parameter->convertTo0to1 (axis.values[getValueIndex (index, i)]);
+            parameter->setValue (value);
+            parameter->sendValueChangedMessageToListeners (value);
+        }
+    }
+
+    p.reset();
+
+    const auto outputFile = getOutputFile (index);
+    outputFile.deleteFile();
+
+    std::unique_ptr<juce::FileOutputStream> stream (outputFile.createOutputStream());
+
+    if (stream == nullptr)
+        return juce::Result::fail ("Can't write to " + outputFile.getFullPathName());
+
+    const int numOutputChannels = p.getMainBusNumOutputChannels();
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+
+    if (settings.format == Format::wav)
+    {
+        juce::WavAudioFormat wavFormat;
+        writer.reset (wavFormat.createWriterFor (stream.get(), settings.sampleRate, (unsigned int) numOutputChannels,
+                                                 settings.bitDepth, {}, 0));
+
+        if (writer == nullptr)
+            return juce::Result::fail ("Can't write a " + juce::String (settings.bitDepth) + "-bit WAV file");
+
+        stream.release(); // the writer owns it now
+    }
+
+    auto& buffer = worker.buffer;
+    auto& midi = worker.midi;
+    const int blockSize = settings.blockSize;
+    size_t nextEvent = 0;
+    RenderCache::Hasher hasher;
+
+    for (juce::int64 position = 0; position < numSamplesPerRender; position += blockSize)
+    {
+        const int numSamples = (int) juce::jmin ((juce::int64) blockSize, numSamplesPerRender - position);
+
+        midi.clear();
+
+        while (nextEvent < events.size() && events[nextEvent].first < position + numSamples)
+        {
+            midi.addEvent (events[nextEvent].second, (int) juce::jmax ((juce::int64) 0, events[nextEvent].first - position));
+            ++nextEvent;
+        }
+
+        buffer.setSize (buffer.getNumChannels(), numSamples, false, false, true);
+        buffer.clear();
+
+        p.processBlock (buffer, midi);
+
+        for (int channel = 0; channel < numOutputChannels; ++channel)
+            for (int sample = 0; sample < numSamples; ++sample)
+                hasher.add (buffer.getSample (channel, sample));
+
+        // Written as it's rendered, so a long render never sits in memory
+        if (writer != nullptr)
+        {
+            writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+            continue;
+        }
+
+        for (int sample = 0; sample < numSamples; ++sample)
+            for (int channel = 0; channel < numOutputChannels; ++channel)
+                stream->writeFloat (buffer.getSample (channel, sample));
+    }
+
+    audioHash = hasher.hash;
+
+    if (writer != nullptr)
+    {
+        writer.reset();
+        return juce::Result::ok();
+    }
+
+    stream->flush();
+    return stream->getStatus();
+}
+
+juce::Result ParameterSweep::writeManifest (const std::vector<bool>& rendered) const
+{
+    const auto manifestFile = outputDirectory.getChildFile ("manifest.csv");
+    manifestFile.deleteFile();
+
+    juce::FileOutputStream stream (manifestFile);
+
+    if (! stream.openedOk())
+        return juce::Result::fail ("Can't write to " + manifestFile.getFullPathName());
+
+    // file, then one column per swept parameter
+    juce::StringArray header { "file" };
+
+    for (const auto& axis : axes)
+        header.add (axis.parameterID);
+
+    stream << header.joinIntoString (",") << "\n";
+
+    for (int i = 0; i < (int) rendered.size(); ++i)
+    {
+        if (! rendered[(size_t) i])
+            continue;
+
+        juce::StringArray row { getOutputFile (i).getFileName() };
+
+        for (int a = 0; a < axes.size(); ++a)
+            row.add (axes.getReference (a).labels[getValueIndex (i, a)]);
+
+        stream << row.joinIntoString (",") << "\n";
+    }
+
+    stream.flush();
+    return stream.getStatus();
+}
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    ParameterSweep.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+// Renders the synth over a grid of parameter values, one file per point, for
+// building datasets.
+//
+// The grid comes from a JSON spec (see loadSpec): a list of values for each
+// swept parameter, plus the notes every render plays. Every combination is
+// rendered offline, the way RenderJob does it, into its own WAV or raw float
+// file, and a manifest.csv lists which file holds which values.
+//
+// The renders are spread over a fixed set of workers, each with its own
+// processor that's made and prepared once. Between renders a worker only sets
+// the parameters and calls reset(), so a render costs what its audio costs.
+// reset() leaves the processor as prepareToPlay did, so a render comes out the
+// same whichever worker did it and whatever it rendered before.
+//
+// Every render's audio is also hashed, to catch grid points that come out
+// the same as another one (a parameter that doesn't reach the synth, or has
+// nothing to act on in this patch).
+//
+// Construct, load and destroy on the message thread; run() blocks it until
+// every render has finished.
+class ParameterSweep
+{
+public:
+    enum class Format
+    {
+        wav,
+        rawFloat    // interleaved 32-bit float, little-endian, no header
+    };
+
+    struct Settings
+    {
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        int bitDepth = 24;      // WAV only: 16, 24 or 32 (float)
+        Format format = Format::wav;
+        int numWorkers = 1;
+    };
+
+    // One swept parameter and the values it takes
+    struct Axis
+    {
+        juce::String parameterID;
+        juce::Array<float> values;
+        juce::StringArray labels;   // for the manifest (a choice's name, or the value)
+    };
+
+    struct Note
+    {
+        int noteNumber = 60;
+        float velocity = 0.8f;
+        double start = 0.0;     // seconds
+        double length = 1.0;
+    };
+
+    ParameterSweep (const juce::File& outputDirectory, const Settings& settings);
+    ~ParameterSweep();
+
+    // {
+    //   "state": "base.xml",           optional, relative to the spec
+    //   "notes": [ { "note": 60, "velocity": 0.8, "start": 0, "length": 1 } ],
+    //   "tail": 1,                     seconds after the last note ends
+    //   "parameters": {
+    //     "waveform": [ "Saw", "Square" ],               values (choice names or numbers)
+    //     "special": { "from": 0, "to": 1, "steps": 5 }, or evenly spaced steps
+    //     "level": 0.8                                    or one value for every render
+    //   }
+    // }
+    //
+    // Parameters are the plugin's parameter IDs; the last one listed changes
+    // fastest from one render to the next. Without "notes", each render is a
+    // one second middle C.
+    juce::Result loadSpec (const juce::File& specFile);
+
+    int getNumRenders() const noexcept;
+
+    // The renders that fail are reported in the result and left out of the
+    // manifest; the others carry on. It also fails if every grid point came
+    // out the same.
+    juce::Result run();
+
+    int getNumRendered() const noexcept         { return numRendered; }
+    int getNumWorkers() const noexcept          { return workers.size(); }
+    double getAudioSeconds() const noexcept     { return audioSeconds; }
+    double getRenderSeconds() const noexcept    { return renderSeconds; }
+    double getRendersPerSecond() const noexcept { return renderSeconds > 0.0 ? numRendered / renderSeconds : 0.0; }
+
+    // Renders whose audio is identical to an earlier grid point's
+    int getNumDuplicates() const noexcept       { return numDuplicates; }
+
+private:
+    struct Worker
+    {
+        std::unique_ptr<_1xOscAudioProcessor> processor;
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer midi;
+    };
+
+    void prepare (Worker& worker) const;
+    juce::Result render (Worker& worker, int index, juce::uint64& audioHash) const;
+    juce::Result writeManifest (const std::vector<bool>& rendered) const;
+
+    int getValueIndex (int renderIndex, int axisIndex) const noexcept;
+    juce::File getOutputFile (int index) const;
+
+    juce::File outputDirectory;
+    Settings settings;
+    juce::OwnedArray<Worker> workers;
+
+    juce::Array<Axis> axes;
+    juce::Array<Note> notes;
+    double tailSeconds = 1.0;
+
+    // The notes as MIDI at sample positions, for every render
+    std::vector<std::pair<juce::int64, juce::MidiMessage>> events;
+    juce::int64 numSamplesPerRender = 0;
+
+    int numRendered = 0;
+    int numDuplicates = 0;
+    double audioSeconds = 0.0;
+    double renderSeconds = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterSweep)
+};
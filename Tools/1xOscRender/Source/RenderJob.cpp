@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    RenderJob.cpp
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "RenderJob.h"
+
+RenderJob::RenderJob (const juce::File& midi, const juce::File& output,
+                      const juce::File& stateFile, const Settings& renderSettings)
+    : midiFile (midi), outputFile (output), settings (renderSettings),
+      processor (std::make_unique<_1xOscAudioProcessor>())
+{
+    loadResult = loadMidi (midiFile, sequence);
+
+    if (loadResult.wasOk() && stateFile != juce::File())
+        loadResult = loadState (*processor, stateFile);
+}
+
+RenderJob::~RenderJob()
+{
+}
+
+juce::Result RenderJob::run()
+{
+    if (loadResult.failed())
+        return loadResult;
+
+    auto& p = *processor;
+    const auto sampleRate = settings.sampleRate;
+    const int blockSize = settings.blockSize;
+
+    // What a host does before an offline bounce
+    p.setNonRealtime (true);
+    p.setRateAndBufferSizeDetails (sampleRate, blockSize);
+    p.prepareToPlay (sampleRate, blockSize);
+
+    const int numOutputChannels = p.getMainBusNumOutputChannels();
+    juce::AudioBuffer<float> buffer (juce::jmax (p.getTotalNumInputChannels(), p.getTotalNumOutputChannels()), blockSize);
+    juce::MidiBuffer midi;
+
+    outputFile.getParentDirectory().createDirectory();
+    outputFile.deleteFile();
+
+    std::unique_ptr<juce::FileOutputStream> stream (outputFile.createOutputStream());
+
+    if (stream == nullptr)
+        return juce::Result::fail ("Can't write to " + outputFile.getFullPathName());
+
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::AudioFormatWriter> writer (wavFormat.createWriterFor (stream.get(), sampleRate,
+                                                                                (unsigned int) numOutputChannels,
+                                                                                settings.bitDepth, {}, 0));
+
+    if (writer == nullptr)
+        return juce::Result::fail ("Can't write a " + juce::String (settings.bitDepth) + "-bit WAV file");
+
+    stream.release(); // the writer owns it now
+
+    const auto totalSamples = (juce::int64) std::ceil ((sequence.getEndTime() + settings.tailSeconds) * sampleRate);
+    int nextEvent = 0;
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    for (juce::int64 position = 0; position < totalSamples; position += blockSize)
+    {
+        const int numSamples = (int) juce::jmin ((juce::int64) blockSize, totalSamples - position);
+
+        // Every event that falls inside this block, at its offset in the block
+        midi.clear();
+
+        while (nextEvent < sequence.getNumEvents())
+        {
+            const auto& message = sequence.getEventPointer (nextEvent)->message;
+            const auto samplePosition = (juce::int64) std::llround (message.getTimeStamp() * sampleRate);
+
+            if (samplePosition >= position + numSamples)
+                break;
+
+            midi.addEvent (message, (int) juce::jmax ((juce::int64) 0, samplePosition - position));
+            ++nextEvent;
+        }
+
+        buffer.setSize (buffer.getNumChannels(), numSamples, false, false, true);
+        buffer.clear();
+
+        p.processBlock (buffer, midi);
+
+        writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+    }
+
+    writer.reset();
+    p.releaseResources();
+
+    renderSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    audioSeconds = (double) totalSamples / sampleRate;
+
+    return juce::Result::ok();
+}
+
+juce::Result RenderJob::loadState (juce::AudioProcessor& processor, const juce::File& stateFile)
+{
+    juce::MemoryBlock state;
+
+    if (stateFile.hasFileExtension ("xml"))
+    {
+        auto xml = juce::parseXML (stateFile);
+
+        if (xml == nullptr)
+            return juce::Result::fail ("Can't read " + stateFile.getFullPathName() + " as XML");
+
+        juce::AudioProcessor::copyXmlToBinary (*xml, state);
+    }
+    else if (! stateFile.loadFileAsData (state) || state.isEmpty())
+    {
+        return juce::Result::fail ("Can't read " + stateFile.getFullPathName());
+    }
+
+    processor.setStateInformation (state.getData(), (int) state.getSize());
+    return juce::Result::ok();
+}
+
+juce::Result RenderJob::loadMidi (const juce::File& file, juce::MidiMessageSequence& result)
+{
+    juce::FileInputStream stream (file);
+    juce::MidiFile midiFile;
+
+    if (! stream.openedOk() || ! midiFile.readFrom (stream))
+        return juce::Result::fail ("Can't read " + file.getFullPathName() + " as a MIDI file");
+
+    midiFile.convertTimestampTicksToSeconds();
+    result.clear();
+
+    for (int track = 0; track < midiFile.getNumTracks(); ++track)
+    {
+        for (auto* event : *midiFile.getTrack (track))
+            if (! event->message.isMetaEvent())
+                result.addEvent (event->message);
+    }
+
+    result.sort();
+    return juce::Result::ok();
+}
@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    RenderJob.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+// One offline render: a Standard MIDI File played through its own instance of
+// the plugin processor, written to a WAV file.
+//
+// The processor is driven exactly the way a host drives it for an offline
+// bounce (non-realtime, fixed block size, MIDI at sample positions inside
+// each block), so the result is bit-identical to bouncing the same MIDI and
+// state in a host at the same sample rate and block size.
+//
+// Construct and destroy on the message thread (that's where the processor
+// and its state live); run() can go on any thread.
+class RenderJob
+{
+public:
+    struct Settings
+    {
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        int bitDepth = 24;          // 16, 24 or 32 (float)
+        double tailSeconds = 2.0;   // rendered after the last MIDI event
+    };
+
+    RenderJob (const juce::File& midiFile, const juce::File& outputFile,
+               const juce::File& stateFile, const Settings& settings);
+    ~RenderJob();
+
+    // Whether the MIDI file and state could be loaded
+    juce::Result getLoadResult() const    { return loadResult; }
+
+    juce::Result run();
+
+    const juce::File& getMidiFile() const noexcept      { return midiFile; }
+    const juce::File& getOutputFile() const noexcept    { return outputFile; }
+
+    double getAudioSeconds() const noexcept     { return audioSeconds; }
+    double getRenderSeconds() const noexcept    { return renderSeconds; }
+    double getRealtimeFactor() const noexcept   { return renderSeconds > 0.0 ? audioSeconds / renderSeconds : 0.0; }
+
+    _1xOscAudioProcessor& getProcessor() noexcept    { return *processor; }
+
+    // Loads a state saved by the plugin (the host's blob) or an .xml preset
+    static juce::Result loadState (juce::AudioProcessor& processor, const juce::File& stateFile);
+
+    // All the note / controller events of every track, timestamped in seconds
+    static juce::Result loadMidi (const juce::File& midiFile, juce::MidiMessageSequence& sequence);
+
+private:
+    juce::File midiFile, outputFile;
+    Settings settings;
+
+    std::unique_ptr<_1xOscAudioProcessor> processor;
+    juce::MidiMessageSequence sequence;
+    juce::Result loadResult = juce::Result::ok();
+
+    double audioSeconds = 0.0;
+    double renderSeconds = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderJob)
+};
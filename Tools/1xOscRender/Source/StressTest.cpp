@@ -0,0 +1,277 @@
+/*
+  ==============================================================================
+
+    StressTest.cpp
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#include "StressTest.h"
+#include "../../../Source/AudioThreadGuard.h"
+
+namespace
+{
+    double ticksToMilliseconds (juce::int64 ticks)
+    {
+        return 1000.0 * (double) ticks / (double) juce::Time::getHighResolutionTicksPerSecond();
+    }
+
+    // Nearest-rank percentile of a sorted list
+    double getPercentile (const std::vector<double>& sorted, double fraction)
+    {
+        if (sorted.empty())
+            return 0.0;
+
+        const auto rank = (size_t) std::ceil (fraction * (double) sorted.size());
+        return sorted[juce::jlimit ((size_t) 0, sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+    }
+}
+
+StressTest::StressTest (const Settings& stressSettings)
+    : settings (stressSettings),
+      processor (std::make_unique<_1xOscAudioProcessor>())
+{
+}
+
+StressTest::~StressTest()
+{
+}
+
+juce::Array<StressTest::Result> StressTest::run()
+{
+    juce::Array<Result> results;
+
+    for (auto blockSize : settings.blockSizes)
+        results.add (runBlockSize (blockSize));
+
+    return results;
+}
+
+StressTest::Result StressTest::runBlockSize (int blockSize)
+{
+    Result result;
+    result.blockSize = blockSize;
+    result.budget = 1000.0 * blockSize / settings.sampleRate;
+    result.numBlocks = juce::jmax (1, (int) std::ceil (settings.secondsPerBlockSize * settings.sampleRate / blockSize));
+
+    // The same storm for every block size
+    random.setSeed (settings.seed);
+    heldNotes.fill (false);
+
+    auto& p = *processor;
+    p.setNonRealtime (false);
+
+    auto prepare = [&]
+    {
+        const auto start = juce::Time::getHighResolutionTicks();
+        p.setRateAndBufferSizeDetails (settings.sampleRate, blockSize);
+        p.prepareToPlay (settings.sampleRate, blockSize);
+        result.maxPrepare = juce::jmax (result.maxPrepare, ticksToMilliseconds (juce::Time::getHighResolutionTicks() - start));
+    };
+
+    prepare();
+
+    juce::AudioBuffer<float> buffer (juce::jmax (p.getTotalNumInputChannels(), p.getTotalNumOutputChannels()), blockSize);
+    juce::MidiBuffer midi;
+    midi.ensureSize (8192 + (size_t) settings.eventsPerBlock * 16);
+
+    std::vector<double> blockTimes;
+    blockTimes.reserve ((size_t) result.numBlocks);
+
+   #if ONEXOSC_AUDIO_THREAD_GUARD
+    AudioThreadGuard::setMode (AudioThreadGuard::Mode::count);
+    AudioThreadGuard::resetViolations();
+   #endif
+
+    for (int block = 0; block < result.numBlocks; ++block)
+    {
+        // What a host does when the device or its settings change
+        if (settings.prepareEvery > 0 && block > 0 && block % settings.prepareEvery == 0)
+        {
+            p.releaseResources();
+            prepare();
+            heldNotes.fill (false);
+            ++result.numPrepareCycles;
+        }
+
+        midi.clear();
+        addMidiStorm (midi, blockSize, result);
+        addDenseTraffic (midi, blockSize, result);
+        automateParameters();
+        result.numMidiEvents += midi.getNumEvents();
+        buffer.clear();
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        p.processBlock (buffer, midi);
+        const auto milliseconds = ticksToMilliseconds (juce::Time::getHighResolutionTicks() - start);
+
+        blockTimes.push_back (milliseconds);
+
+        if (milliseconds > result.budget)
+            ++result.numOverruns;
+    }
+
+   #if ONEXOSC_AUDIO_THREAD_GUARD
+    result.numGuardViolations = AudioThreadGuard::getNumViolations();
+    AudioThreadGuard::setMode (AudioThreadGuard::Mode::off);
+   #endif
+
+    p.releaseResources();
+
+    result.mean = std::accumulate (blockTimes.begin(), blockTimes.end(), 0.0) / (double) blockTimes.size();
+    std::sort (blockTimes.begin(), blockTimes.end());
+
+    result.p50  = getPercentile (blockTimes, 0.5);
+    result.p99  = getPercentile (blockTimes, 0.99);
+    result.p999 = getPercentile (blockTimes, 0.999);
+    result.max  = blockTimes.back();
+
+    return result;
+}
+
+void StressTest::addMidiStorm (juce::MidiBuffer& midi, int numSamples, Result& result)
+{
+    auto randomChannel = [this] { return 1 + random.nextInt (16); };
+    auto randomPosition = [this, numSamples] { return random.nextInt (numSamples); };
+
+    // A chord or a cluster in about one block in eight, all of it landing
+    // somewhere inside the block
+    if (random.nextInt (8) == 0)
+    {
+        const int numNotes = 1 + random.nextInt (juce::jmax (1, settings.maxNotesPerBurst));
+
+        for (int i = 0; i < numNotes; ++i)
+        {
+            const int note = random.nextInt (128);
+            midi.addEvent (juce::MidiMessage::noteOn (randomChannel(), note, (juce::uint8) (1 + random.nextInt (127))), randomPosition());
+            heldNotes[(size_t) note] = true;
+            ++result.numNotesStarted;
+        }
+    }
+
+    // Let go of some of what's held
+    for (int note = 0; note < 128; ++note)
+    {
+        if (heldNotes[(size_t) note] && random.nextInt (16) == 0)
+        {
+            midi.addEvent (juce::MidiMessage::noteOff (randomChannel(), note), randomPosition());
+            heldNotes[(size_t) note] = false;
+        }
+    }
+
+    if (random.nextInt (4) == 0)
+        midi.addEvent (juce::MidiMessage::pitchWheel (randomChannel(), random.nextInt (16384)), randomPosition());
+
+    if (random.nextInt (8) == 0)
+        midi.addEvent (juce::MidiMessage::controllerEvent (randomChannel(), 1, random.nextInt (128)), randomPosition());
+
+    if (random.nextInt (64) == 0)
+        midi.addEvent (juce::MidiMessage::controllerEvent (randomChannel(), 64, random.nextBool() ? 127 : 0), randomPosition());
+
+    if (random.nextInt (512) == 0)
+    {
+        for (int channel = 1; channel <= 16; ++channel)
+            midi.addEvent (juce::MidiMessage::allNotesOff (channel), randomPosition());
+
+        heldNotes.fill (false);
+    }
+}
+
+void StressTest::addDenseTraffic (juce::MidiBuffer& midi, int numSamples, Result& result)
+{
+    // Counted as events: a note is two of them
+    for (int i = 0; i < settings.eventsPerBlock; ++i)
+    {
+        const int channel = 1 + random.nextInt (16);
+        const int position = random.nextInt (numSamples);
+        const int kind = random.nextInt (16);
+
+        if (kind < 8)
+        {
+            // mod wheel, expression, cutoff, ... as an LFO or a fader sends them
+            static constexpr int controllers[] = { 1, 2, 7, 11, 71, 74 };
+            midi.addEvent (juce::MidiMessage::controllerEvent (channel, controllers[random.nextInt (6)], random.nextInt (128)), position);
+        }
+        else if (kind < 12)
+        {
+            midi.addEvent (juce::MidiMessage::pitchWheel (channel, random.nextInt (16384)), position);
+        }
+        else if (kind < 14)
+        {
+            midi.addEvent (juce::MidiMessage::channelPressureChange (channel, random.nextInt (128)), position);
+        }
+        else
+        {
+            // a short note, let go of somewhere later in the block
+            const int note = random.nextInt (128);
+            const int end = position + random.nextInt (numSamples - position);
+            midi.addEvent (juce::MidiMessage::noteOn (channel, note, (juce::uint8) (1 + random.nextInt (127))), position);
+            midi.addEvent (juce::MidiMessage::noteOff (channel, note), end);
+            ++result.numNotesStarted;
+            ++i;
+        }
+    }
+}
+
+void StressTest::automateParameters()
+{
+    // Dense host automation: about a quarter of the parameters move every
+    // block, set the way plugin wrappers do it on the audio thread
+    for (auto* param : processor->getParameters())
+    {
+        if (random.nextInt (4) == 0)
+        {
+            const auto value = random.nextFloat();
+            param->setValue (value);
+            param->sendValueChangedMessageToListeners (value);
+        }
+    }
+
+    // plus waveform jumps, which swap the oscillator kernel under the voices
+    if (random.nextInt (16) == 0)
+    {
+        if (auto* waveform = dynamic_cast<juce::AudioParameterChoice*> (processor->apvts.getParameter ("waveform")))
+        {
+            const auto value = waveform->convertTo0to1 ((float) random.nextInt (waveform->choices.size()));
+            waveform->setValue (value);
+            waveform->sendValueChangedMessageToListeners (value);
+        }
+    }
+}
+
+juce::var StressTest::toJson (const Settings& testSettings, const juce::Array<Result>& results)
+{
+    auto* root = new juce::DynamicObject();
+    root->setProperty ("sampleRate", testSettings.sampleRate);
+    root->setProperty ("secondsPerBlockSize", testSettings.secondsPerBlockSize);
+    root->setProperty ("seed", testSettings.seed);
+    root->setProperty ("prepareEvery", testSettings.prepareEvery);
+    root->setProperty ("maxNotesPerBurst", testSettings.maxNotesPerBurst);
+    root->setProperty ("eventsPerBlock", testSettings.eventsPerBlock);
+
+    juce::Array<juce::var> list;
+
+    for (const auto& result : results)
+    {
+        auto* entry = new juce::DynamicObject();
+        entry->setProperty ("blockSize", result.blockSize);
+        entry->setProperty ("blocks", result.numBlocks);
+        entry->setProperty ("prepareCycles", result.numPrepareCycles);
+        entry->setProperty ("notesStarted", result.numNotesStarted);
+        entry->setProperty ("midiEvents", result.numMidiEvents);
+        entry->setProperty ("overruns", result.numOverruns);
+        entry->setProperty ("budgetMs", result.budget);
+        entry->setProperty ("meanMs", result.mean);
+        entry->setProperty ("p50Ms", result.p50);
+        entry->setProperty ("p99Ms", result.p99);
+        entry->setProperty ("p999Ms", result.p999);
+        entry->setProperty ("maxMs", result.max);
+        entry->setProperty ("maxPrepareMs", result.maxPrepare);
+        entry->setProperty ("guardViolations", result.numGuardViolations);
+        list.add (juce::var (entry));
+    }
+
+    root->setProperty ("results", list);
+    return juce::var (root);
+}
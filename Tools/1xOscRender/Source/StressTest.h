@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    StressTest.h
+    Created: 18 Oct 2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+// Worst-case latency harness: drives one instance of the plugin processor the
+// way a busy live session does, and records how long every processBlock takes.
+//
+// Every block gets seeded random MIDI (bursts of chords, note offs, pitch bend,
+// controllers, the odd all-notes-off) and host-style automation of every
+// parameter, with extra waveform switches on top. Every so often the processor
+// is released and prepared again, as a host does when the device changes.
+//
+// eventsPerBlock adds the traffic of a MIDI effect or generator on top: that
+// many events in every block, mostly controllers, pitch bend and pressure,
+// with short notes among them. That's what the MIDI grid (see
+// MidiEventCoalescer) is for, so it's the load to compare it on.
+//
+// The same seed always produces the same storm, so two builds can be compared
+// block for block. The results are the block time distribution against the
+// real-time budget (blockSize / sampleRate), per block size.
+//
+// Construct, run and destroy on the message thread.
+class StressTest
+{
+public:
+    struct Settings
+    {
+        double sampleRate = 48000.0;
+        juce::Array<int> blockSizes { 64, 128, 256, 512 };
+        double secondsPerBlockSize = 30.0;  // of audio, per block size
+        juce::int64 seed = 1;
+        int prepareEvery = 4000;            // blocks between prepareToPlay cycles, 0 = never
+        int maxNotesPerBurst = 16;
+        int eventsPerBlock = 0;             // dense MIDI on top of the storm, 0 = none
+    };
+
+    struct Result
+    {
+        int blockSize = 0;
+        int numBlocks = 0;
+        int numPrepareCycles = 0;
+        int numNotesStarted = 0;
+        juce::int64 numMidiEvents = 0;      // sent to processBlock, before any coalescing
+        int numOverruns = 0;                // blocks that took longer than the budget
+
+        // milliseconds
+        double budget = 0.0;
+        double mean = 0.0;
+        double p50 = 0.0;
+        double p99 = 0.0;
+        double p999 = 0.0;
+        double max = 0.0;
+        double maxPrepare = 0.0;
+
+        int numGuardViolations = 0;         // only counted with ONEXOSC_AUDIO_THREAD_GUARD
+
+        double getPercentOfBudget (double milliseconds) const noexcept
+        {
+            return budget > 0.0 ? 100.0 * milliseconds / budget : 0.0;
+        }
+    };
+
+    explicit StressTest (const Settings& settings);
+    ~StressTest();
+
+    // Runs every block size in turn, each starting the storm from the seed
+    juce::Array<Result> run();
+
+    const Settings& getSettings() const noexcept    { return settings; }
+    _1xOscAudioProcessor& getProcessor() noexcept   { return *processor; }
+
+    // The results as JSON, for CI to keep and compare
+    static juce::var toJson (const Settings& testSettings, const juce::Array<Result>& results);
+
+private:
+    Result runBlockSize (int blockSize);
+
+    void addMidiStorm (juce::MidiBuffer& midi, int numSamples, Result& result);
+    void addDenseTraffic (juce::MidiBuffer& midi, int numSamples, Result& result);
+    void automateParameters();
+
+    Settings settings;
+    std::unique_ptr<_1xOscAudioProcessor> processor;
+    juce::Random random;
+
+    std::array<bool, 128> heldNotes {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StressTest)
+};